@@ -0,0 +1,389 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Return value optimisation - https://en.cppreference.com/w/cpp/language/copy_elision
+//
+// Heap allocation is rarely visible in the source: it hides in copies, in growth, and in
+// temporaries. Each malloc/free pair is tens of nanoseconds at best, takes locks or touches
+// shared state at worst, and the new block is cold in cache. bench/allocations.h counts every
+// allocation made by each benchmark iteration so the numbers below can be checked.
+//
+// Returning a container by value doesn't copy it. Since C++17 returning a prvalue is guaranteed
+// to construct straight into the caller's object, and returning a named local is almost always
+// elided too (NRVO). When NRVO can't apply, the return is a move, which is still allocation free.
+//
+// return std::move(local) is a pessimisation: it turns an elided return into a move. And the
+// output parameter style gives up nothing but readability.
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include <cstddef> //size_t
+#include <utility>
+#include <vector>
+
+std::vector<int> make_vector_1(std::size_t n) {
+    std::vector<int> v(n, 1);
+    return v; // NRVO: v is constructed in the caller's object, 1 allocation
+}
+
+std::vector<int> make_vector_2(std::size_t n) {
+    std::vector<int> v(n, 1);
+    return std::move(v); // no elision, moved instead: still 1 allocation, but -Wpessimizing-move
+}
+
+std::vector<int> make_vector_3(std::size_t n, bool odd) {
+    std::vector<int> a(n, 1);
+    std::vector<int> b(n, 2);
+    return odd ? a : b; // the ?: is a new prvalue copied from a or b: 3 allocations
+}
+
+std::vector<int> make_vector_4(std::size_t n, bool odd) {
+    std::vector<int> a(n, 1);
+    std::vector<int> b(n, 2);
+    if (odd) {
+        return a; // two candidates, so no NRVO, but each return is an implicit move: 2 allocations
+    }
+    return b;
+}
+
+void make_vector_5(std::size_t n, std::vector<int> &out) {
+    out.assign(n, 1); // reuses out's buffer if it's big enough: 0 or 1 allocations
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Move vs copy
+//
+// Passing or storing an lvalue copies it: a fresh allocation plus a copy of every element.
+// std::move casts it to an rvalue so the move constructor can steal the buffer instead (three
+// pointer writes). Only do it when the source isn't needed afterwards - a moved-from vector is
+// valid but unspecified (empty in practice).
+//
+// Taking a sink parameter by value lets the caller choose: copy in if they need to keep theirs,
+// move in if they don't.
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include <string>
+#include <utility>
+#include <vector>
+
+struct record {
+    std::string name;
+    std::vector<int> values;
+};
+
+record make_record_1(const std::string &name, const std::vector<int> &values) {
+    return record{name, values}; // always copies both
+}
+
+record make_record_2(std::string name, std::vector<int> values) {
+    return record{std::move(name), std::move(values)}; // copies only what the caller copied in
+}
+
+void store_1(std::vector<record> &out, record r) {
+    out.push_back(r); // r is an lvalue here: copies name and values
+}
+
+void store_2(std::vector<record> &out, record r) {
+    out.push_back(std::move(r)); // moves them
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Reserve vs growth
+//
+// push_back into a vector without room allocates a bigger buffer (2x in libstdc++, 1.5x in
+// MSVC), moves every element across and frees the old one. Filling 1000 ints one at a time does
+// 11 allocations and copies ~1000 ints more than needed. If the final size is known, or can be
+// bounded, reserve it once.
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include <cstddef> //size_t
+#include <vector>
+
+std::vector<int> fill_1(std::size_t n) {
+    std::vector<int> v;
+    for (std::size_t i = 0; i < n; ++i) {
+        v.push_back(static_cast<int>(i)); // log2(n) + 1 allocations
+    }
+    return v;
+}
+
+std::vector<int> fill_2(std::size_t n) {
+    std::vector<int> v;
+    v.reserve(n); // 1 allocation
+    for (std::size_t i = 0; i < n; ++i) {
+        v.push_back(static_cast<int>(i));
+    }
+    return v;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Reusing buffers across calls
+//
+// A function that needs scratch space and is called in a loop allocates and frees it every
+// call. clear() destroys the elements but keeps the capacity, so passing the scratch buffer in
+// (or keeping it in the object that owns the loop) means it's only ever allocated on the first
+// call, and after that it's warm in cache as well.
+//
+// A thread_local or static scratch buffer does the same without changing the signature, at the
+// cost of hidden state and memory that is never given back.
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include <cstddef> //size_t
+#include <vector>
+
+// sum of the values at even positions after doubling them
+int scratch_1(const std::vector<int> &in) {
+    std::vector<int> scratch; // grown from nothing and freed every call
+    for (std::size_t i = 0; i < in.size(); i += 2) {
+        scratch.push_back(in[i] * 2);
+    }
+    int sum = 0;
+    for (int x : scratch) {
+        sum += x;
+    }
+    return sum;
+}
+
+int scratch_2(const std::vector<int> &in, std::vector<int> &scratch) {
+    scratch.clear(); // keeps its capacity from the previous call
+    for (std::size_t i = 0; i < in.size(); i += 2) {
+        scratch.push_back(in[i] * 2);
+    }
+    int sum = 0;
+    for (int x : scratch) {
+        sum += x;
+    }
+    return sum;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Monotonic arena - https://en.cppreference.com/w/cpp/memory/memory_resource
+//
+// When a piece of work (a request, a frame, one call of a kernel) makes lots of short lived
+// allocations that all die together, give it an arena: allocation is a pointer bump, deallocate
+// does nothing, and reset() hands everything back at once at the end. Unlike
+// std::pmr::monotonic_buffer_resource, whose release() returns its memory to upstream, reset()
+// keeps the chunks, so after the first round there are no calls to malloc at all.
+//
+// Deriving from std::pmr::memory_resource means any std::pmr container can use it without
+// changing its type per allocator: std::pmr::vector<int> v(&arena);
+//
+// Memory freed into an arena is not reused until reset(), so a vector growing by push_back
+// leaves every old buffer behind it. reserve() first, or use a pool for things that churn.
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include <cstddef> //size_t
+#include <memory>  //align
+#include <memory_resource>
+#include <vector>
+
+class arena_resource : public std::pmr::memory_resource {
+public:
+    explicit arena_resource(std::size_t chunk_size = 64 * 1024,
+                            std::pmr::memory_resource *upstream = std::pmr::get_default_resource())
+        : next_size_(chunk_size), upstream_(upstream) {}
+
+    arena_resource(const arena_resource &) = delete;
+    arena_resource &operator=(const arena_resource &) = delete;
+
+    ~arena_resource() override {
+        for (const chunk &c : chunks_) {
+            upstream_->deallocate(c.data, c.size, alignof(std::max_align_t));
+        }
+    }
+
+    // everything allocated so far is dead, start again from the first chunk
+    void reset() {
+        next_ = 0;
+        current_ = end_ = nullptr;
+    }
+
+    std::size_t capacity() const {
+        std::size_t total = 0;
+        for (const chunk &c : chunks_) {
+            total += c.size;
+        }
+        return total;
+    }
+
+private:
+    struct chunk {
+        char *data;
+        std::size_t size;
+    };
+
+    void *do_allocate(std::size_t bytes, std::size_t alignment) override {
+        for (;;) {
+            void *p = current_;
+            std::size_t space = end_ - current_;
+            if (std::align(alignment, bytes, p, space) != nullptr) {
+                current_ = static_cast<char *>(p) + bytes;
+                return p;
+            }
+            next_chunk(bytes + alignment);
+        }
+    }
+
+    void do_deallocate(void *, std::size_t, std::size_t) override {}
+
+    bool do_is_equal(const std::pmr::memory_resource &other) const noexcept override {
+        return this == &other;
+    }
+
+    // move to the next chunk that can hold min bytes, allocating one if there isn't one
+    void next_chunk(std::size_t min) {
+        while (next_ < chunks_.size() && chunks_[next_].size < min) {
+            ++next_;
+        }
+        if (next_ == chunks_.size()) {
+            const std::size_t size = next_size_ > min ? next_size_ : min;
+            chunks_.push_back({static_cast<char *>(upstream_->allocate(size, alignof(std::max_align_t))), size});
+            next_size_ *= 2;
+        }
+        current_ = chunks_[next_].data;
+        end_ = current_ + chunks_[next_].size;
+        ++next_;
+    }
+
+    char *current_ = nullptr;
+    char *end_ = nullptr;
+    std::vector<chunk> chunks_;
+    std::size_t next_ = 0; // index of the chunk after current_'s
+    std::size_t next_size_;
+    std::pmr::memory_resource *upstream_;
+};
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Fixed size pool
+//
+// Node based containers (std::map, std::list, std::unordered_map) allocate one node per element
+// and free them one at a time, in any order, so an arena would never get the memory back. When
+// every block is the same size, a free list is all that's needed: a freed block holds the pointer
+// to the next free one, allocate pops the head and deallocate pushes onto it. Both are a couple
+// of instructions and blocks are carved out of large chunks, so neighbouring nodes tend to be
+// neighbours in memory too.
+//
+// Requests bigger than the block size (a std::unordered_map's bucket array, say) are passed
+// through to upstream. std::pmr::unsynchronized_pool_resource is the general version, with one
+// pool per size class.
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include <cstddef> //size_t, max_align_t
+#include <memory_resource>
+#include <vector>
+
+class fixed_pool_resource : public std::pmr::memory_resource {
+public:
+    explicit fixed_pool_resource(std::size_t block_size, std::size_t blocks_per_chunk = 1024,
+                                 std::pmr::memory_resource *upstream = std::pmr::get_default_resource())
+        : block_size_(round_up(block_size)), blocks_per_chunk_(blocks_per_chunk), upstream_(upstream) {}
+
+    fixed_pool_resource(const fixed_pool_resource &) = delete;
+    fixed_pool_resource &operator=(const fixed_pool_resource &) = delete;
+
+    ~fixed_pool_resource() override {
+        for (void *c : chunks_) {
+            upstream_->deallocate(c, block_size_ * blocks_per_chunk_, alignof(std::max_align_t));
+        }
+    }
+
+    std::size_t block_size() const { return block_size_; }
+
+private:
+    struct free_block {
+        free_block *next;
+    };
+
+    static std::size_t round_up(std::size_t size) {
+        constexpr std::size_t align = alignof(std::max_align_t);
+        size = size < sizeof(free_block) ? sizeof(free_block) : size;
+        return (size + align - 1) / align * align;
+    }
+
+    bool fits(std::size_t bytes, std::size_t alignment) const {
+        return bytes <= block_size_ && alignment <= alignof(std::max_align_t);
+    }
+
+    void *do_allocate(std::size_t bytes, std::size_t alignment) override {
+        if (!fits(bytes, alignment)) [[unlikely]] {
+            return upstream_->allocate(bytes, alignment);
+        }
+        if (free_ == nullptr) [[unlikely]] {
+            refill();
+        }
+        free_block *b = free_;
+        free_ = b->next;
+        return b;
+    }
+
+    void do_deallocate(void *p, std::size_t bytes, std::size_t alignment) override {
+        if (!fits(bytes, alignment)) [[unlikely]] {
+            upstream_->deallocate(p, bytes, alignment);
+            return;
+        }
+        free_ = ::new (p) free_block{free_};
+    }
+
+    bool do_is_equal(const std::pmr::memory_resource &other) const noexcept override {
+        return this == &other;
+    }
+
+    // carve a new chunk into blocks, linked in address order
+    void refill() {
+        char *c = static_cast<char *>(upstream_->allocate(block_size_ * blocks_per_chunk_, alignof(std::max_align_t)));
+        chunks_.push_back(c);
+        for (std::size_t i = blocks_per_chunk_; i-- > 0;) {
+            free_ = ::new (c + i * block_size_) free_block{free_};
+        }
+    }
+
+    free_block *free_ = nullptr;
+    std::size_t block_size_;
+    std::size_t blocks_per_chunk_;
+    std::vector<void *> chunks_;
+    std::pmr::memory_resource *upstream_;
+};
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Per-thread arenas
+//
+// A resource shared between threads needs a lock (std::pmr::synchronized_pool_resource) or
+// atomics, and the cache line holding its state bounces between cores. malloc avoids most of
+// that with per-thread caches, but still pays for the bookkeeping that lets any thread free any
+// block.
+//
+// Giving each thread its own arena needs no synchronisation at all. The rules that make it safe:
+// memory from a thread's arena is only used while that thread's current piece of work is alive,
+// and only that thread calls reset(). Handing a result to another thread means copying it out
+// into memory from a shared resource.
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include <memory_resource>
+#include <vector>
+
+arena_resource &thread_arena() {
+    thread_local arena_resource arena(256 * 1024);
+    return arena;
+}
+
+// one piece of work: everything it allocates comes from this thread's arena and is dropped at once
+template <typename F>
+auto with_thread_arena(F &&work) {
+    arena_resource &arena = thread_arena();
+    struct reset_on_exit {
+        arena_resource &arena;
+        ~reset_on_exit() { arena.reset(); }
+    } guard{arena};
+    return work(static_cast<std::pmr::memory_resource *>(&arena));
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,322 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Benchmarks for allocation.cpp
+//
+//   g++ -std=c++20 -O2 -march=native -pthread -o allocation_bench bench/allocation.cpp
+//
+// Each variant's timing row (per element) comes with the allocations and bytes one call made,
+// counted by the operator new/delete replacements in allocations.h. Allocations an arena or pool
+// serves from memory it already holds don't reach operator new, so they count as zero.
+//
+// The multithreaded rows only show contention on a machine with a core per thread. Their threads
+// are started on every call, so each thread_arena is new and its first chunks are counted.
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include "../allocation.cpp"
+
+#include "allocations.h"
+#include "bench.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <map>
+#include <memory_resource>
+#include <random>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace {
+
+void check(bool ok, const char *what) {
+    if (!ok) {
+        std::fprintf(stderr, "%s: wrong result\n", what);
+        std::exit(1);
+    }
+}
+
+void return_value(std::size_t n) {
+    const char *section = "return_value_optimisation";
+    bool odd = false;
+    bench::run_counted(section, "make_vector_1 (NRVO)", n, [&] {
+        bench::do_not_optimise(make_vector_1(n).data());
+    });
+    bench::run_counted(section, "make_vector_2 (return std::move)", n, [&] {
+        bench::do_not_optimise(make_vector_2(n).data());
+    });
+    bench::run_counted(section, "make_vector_3 (return ?:)", n, [&] {
+        odd = !odd;
+        bench::do_not_optimise(make_vector_3(n, odd).data());
+    });
+    bench::run_counted(section, "make_vector_4 (two returns)", n, [&] {
+        odd = !odd;
+        bench::do_not_optimise(make_vector_4(n, odd).data());
+    });
+    std::vector<int> out;
+    bench::run_counted(section, "make_vector_5 (output parameter)", n, [&] {
+        make_vector_5(n, out);
+        bench::do_not_optimise(out.data());
+    });
+    check(make_vector_1(n) == make_vector_2(n) && make_vector_3(n, true) == make_vector_4(n, true) &&
+              make_vector_3(n, false) == make_vector_4(n, false) && out == make_vector_1(n),
+          section);
+}
+
+void move_copy(std::size_t n) {
+    const char *section = "move_vs_copy";
+    std::string name(40, 'x'); // too long for std::string's SSO
+    std::vector<int> values(n, 1);
+
+    bench::run_counted(section, "make_record_1 (const&)", n, [&] {
+        const record r = make_record_1(name, values);
+        bench::do_not_optimise(r.values.data());
+    });
+    bench::run_counted(section, "make_record_2 (copied in)", n, [&] {
+        const record r = make_record_2(name, values);
+        bench::do_not_optimise(r.values.data());
+    });
+    bench::run_counted(section, "make_record_2 (moved in)", n, [&] {
+        record r = make_record_2(std::move(name), std::move(values));
+        bench::do_not_optimise(r.values.data());
+        // hand them back for the next call
+        name = std::move(r.name);
+        values = std::move(r.values);
+    });
+    check(name.size() == 40 && values.size() == n, section);
+
+    std::vector<record> out;
+    out.reserve(1);
+    bench::run_counted(section, "store_1 (push_back lvalue)", n, [&] {
+        out.clear();
+        store_1(out, make_record_2(name, values));
+    });
+    bench::run_counted(section, "store_2 (push_back std::move)", n, [&] {
+        out.clear();
+        store_2(out, make_record_2(name, values));
+    });
+    check(out.size() == 1 && out[0].name == name && out[0].values == values, section);
+}
+
+void growth(std::size_t n) {
+    const char *section = "reserve_vs_growth";
+    bench::run_counted(section, "fill_1 (push_back)", n, [&] {
+        bench::do_not_optimise(fill_1(n).data());
+    });
+    bench::run_counted(section, "fill_2 (reserve)", n, [&] {
+        bench::do_not_optimise(fill_2(n).data());
+    });
+    check(fill_1(n) == fill_2(n), section);
+}
+
+void scratch(std::size_t n) {
+    const char *section = "reusing_buffers_across_calls";
+    std::vector<int> in(n);
+    for (std::size_t i = 0; i < n; ++i) {
+        in[i] = static_cast<int>(i % 100);
+    }
+    std::vector<int> buffer;
+    bench::run_counted(section, "scratch_1 (local)", n, [&] {
+        bench::do_not_optimise(scratch_1(in));
+    });
+    bench::run_counted(section, "scratch_2 (reused)", n, [&] {
+        bench::do_not_optimise(scratch_2(in, buffer));
+    });
+    check(scratch_1(in) == scratch_2(in, buffer), section);
+}
+
+// the kind of work branch_while does, over a few vectors built up by push_back
+template <typename Vector>
+int vector_work(std::size_t n, const typename Vector::allocator_type &alloc) {
+    int sum = 0;
+    for (int k = 0; k < 4; ++k) {
+        Vector v(alloc);
+        for (std::size_t i = 0; i < n; ++i) {
+            v.push_back(static_cast<int>(i));
+        }
+        for (int &x : v) {
+            x += 1;
+        }
+        for (int x : v) {
+            sum += x;
+        }
+    }
+    return sum;
+}
+
+void arena(std::size_t n) {
+    const char *section = "monotonic_arena";
+    const std::size_t items = 4 * n;
+    const int expected = vector_work<std::vector<int>>(n, {});
+    int got = 0;
+
+    bench::run_counted(section, "std::vector", items, [&] {
+        got = vector_work<std::vector<int>>(n, {});
+        bench::do_not_optimise(got);
+    });
+    check(got == expected, "std::vector");
+    bench::run_counted(section, "pmr::vector/new_delete_resource", items, [&] {
+        got = vector_work<std::pmr::vector<int>>(n, std::pmr::new_delete_resource());
+        bench::do_not_optimise(got);
+    });
+    check(got == expected, "new_delete_resource");
+    bench::run_counted(section, "pmr::vector/monotonic_buffer_resource", items, [&] {
+        std::pmr::monotonic_buffer_resource resource;
+        got = vector_work<std::pmr::vector<int>>(n, &resource);
+        bench::do_not_optimise(got);
+    });
+    check(got == expected, "monotonic_buffer_resource");
+    arena_resource resource;
+    bench::run_counted(section, "pmr::vector/arena_resource", items, [&] {
+        got = vector_work<std::pmr::vector<int>>(n, &resource);
+        resource.reset();
+        bench::do_not_optimise(got);
+    });
+    check(got == expected, "arena_resource");
+}
+
+// insert n keys into a map, erase every other one and look them all up
+template <typename Map>
+long map_work(const std::vector<int> &keys, const typename Map::allocator_type &alloc) {
+    Map map(alloc);
+    for (int k : keys) {
+        map.emplace(k, k);
+    }
+    for (std::size_t i = 0; i < keys.size(); i += 2) {
+        map.erase(keys[i]);
+    }
+    long sum = 0;
+    for (int k : keys) {
+        const auto it = map.find(k);
+        sum += it == map.end() ? 0 : it->second;
+    }
+    return sum;
+}
+
+std::vector<int> random_keys(std::size_t n, unsigned seed) {
+    std::mt19937 rng(seed);
+    std::vector<int> keys(n);
+    for (std::size_t i = 0; i < n; ++i) {
+        keys[i] = static_cast<int>(i);
+    }
+    std::shuffle(keys.begin(), keys.end(), rng);
+    return keys;
+}
+
+using int_map = std::map<int, int>;
+using pmr_int_map = std::pmr::map<int, int>;
+
+// a std::map<int, int> node is 40 bytes in libstdc++, rounded up to 48
+constexpr std::size_t map_node_size = 48;
+
+void pool(std::size_t n) {
+    const char *section = "fixed_size_pool";
+    const std::vector<int> keys = random_keys(n, 1);
+    const long expected = map_work<int_map>(keys, {});
+    long got = 0;
+
+    bench::run_counted(section, "std::map", n, [&] {
+        got = map_work<int_map>(keys, {});
+        bench::do_not_optimise(got);
+    });
+    check(got == expected, "std::map");
+    fixed_pool_resource fixed(map_node_size);
+    bench::run_counted(section, "pmr::map/fixed_pool_resource", n, [&] {
+        got = map_work<pmr_int_map>(keys, &fixed);
+        bench::do_not_optimise(got);
+    });
+    check(got == expected, "fixed_pool_resource");
+    std::pmr::unsynchronized_pool_resource unsynchronized;
+    bench::run_counted(section, "pmr::map/unsynchronized_pool_resource", n, [&] {
+        got = map_work<pmr_int_map>(keys, &unsynchronized);
+        bench::do_not_optimise(got);
+    });
+    check(got == expected, "unsynchronized_pool_resource");
+    arena_resource arena;
+    bench::run_counted(section, "pmr::map/arena_resource", n, [&] {
+        got = map_work<pmr_int_map>(keys, &arena);
+        arena.reset();
+        bench::do_not_optimise(got);
+    });
+    check(got == expected, "arena_resource");
+}
+
+// each thread does `rounds` map_works on its own keys
+template <typename Work>
+void on_threads(unsigned threads, Work &&work) {
+    std::vector<std::thread> pool;
+    for (unsigned t = 0; t < threads; ++t) {
+        pool.emplace_back([&work, t] { work(t); });
+    }
+    for (std::thread &t : pool) {
+        t.join();
+    }
+}
+
+void threads(std::size_t n) {
+    const char *section = "per_thread_arenas";
+    constexpr unsigned thread_count = 4;
+    constexpr int rounds = 8;
+    const std::size_t items = thread_count * rounds * n;
+    std::vector<std::vector<int>> keys;
+    for (unsigned t = 0; t < thread_count; ++t) {
+        keys.push_back(random_keys(n, t));
+    }
+    std::vector<long> expected(thread_count), got(thread_count);
+    for (unsigned t = 0; t < thread_count; ++t) {
+        expected[t] = rounds * map_work<int_map>(keys[t], {});
+    }
+    auto check_all = [&](const char *what) {
+        check(got == expected, what);
+    };
+
+    bench::run_counted(section, "std::map", items, [&] {
+        on_threads(thread_count, [&](unsigned t) {
+            long sum = 0;
+            for (int r = 0; r < rounds; ++r) {
+                sum += map_work<int_map>(keys[t], {});
+            }
+            got[t] = sum;
+        });
+    });
+    check_all("std::map");
+    std::pmr::synchronized_pool_resource shared;
+    bench::run_counted(section, "pmr::map/shared synchronized_pool_resource", items, [&] {
+        on_threads(thread_count, [&](unsigned t) {
+            long sum = 0;
+            for (int r = 0; r < rounds; ++r) {
+                sum += map_work<pmr_int_map>(keys[t], &shared);
+            }
+            got[t] = sum;
+        });
+    });
+    check_all("synchronized_pool_resource");
+    bench::run_counted(section, "pmr::map/thread_arena", items, [&] {
+        on_threads(thread_count, [&](unsigned t) {
+            long sum = 0;
+            for (int r = 0; r < rounds; ++r) {
+                sum += with_thread_arena([&](std::pmr::memory_resource *arena) {
+                    return map_work<pmr_int_map>(keys[t], arena);
+                });
+            }
+            got[t] = sum;
+        });
+    });
+    check_all("thread_arena");
+}
+
+} // namespace
+
+int main() {
+    bench::header();
+    for (std::size_t n : {16, 1000, 100000}) {
+        return_value(n);
+        move_copy(n);
+        growth(n);
+        scratch(n);
+        arena(n);
+        pool(n);
+        threads(n);
+    }
+    return 0;
+}
@@ -0,0 +1,115 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Allocation counting
+//
+// Replaces the global operator new/delete so every heap allocation made through them (containers,
+// strings, make_unique...) is counted. Include it from exactly one translation unit per benchmark
+// program, since the replacements are ordinary (non-inline) definitions.
+//
+// bench::run_counted times f() like bench::run, then calls it once more on its own and reports
+// the allocations and bytes that one call made as counters (stderr), next to its timing row:
+//
+//   section,variant/size,allocations_per_iteration,N
+//   section,variant/size,bytes_per_iteration,N
+//
+// Counting is a relaxed atomic add per allocation, so the timed numbers include a little of it.
+// Memory from malloc directly, or from a custom allocator that doesn't use operator new, is not
+// counted.
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "bench.h"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+#include <string>
+
+namespace bench {
+
+struct allocation_count {
+    std::size_t allocations = 0;
+    std::size_t bytes = 0;
+};
+
+namespace detail {
+inline std::atomic<std::size_t> allocations{0};
+inline std::atomic<std::size_t> bytes{0};
+
+inline void *counted_alloc(std::size_t size, std::size_t align = 0) {
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    bytes.fetch_add(size, std::memory_order_relaxed);
+    if (size == 0) {
+        size = 1;
+    }
+    void *p = align > alignof(std::max_align_t)
+                  ? std::aligned_alloc(align, (size + align - 1) / align * align)
+                  : std::malloc(size);
+    if (p == nullptr) {
+        throw std::bad_alloc();
+    }
+    return p;
+}
+} // namespace detail
+
+// totals since the program started; subtract two of these to count a region
+inline allocation_count allocations() {
+    return {detail::allocations.load(std::memory_order_relaxed),
+            detail::bytes.load(std::memory_order_relaxed)};
+}
+
+// allocations made by one call of f()
+template <typename F>
+allocation_count count_allocations(F &&f) {
+    const allocation_count before = allocations();
+    f();
+    clobber_memory();
+    const allocation_count after = allocations();
+    return {after.allocations - before.allocations, after.bytes - before.bytes};
+}
+
+// bench::run, plus the allocations and bytes of a single call as counters. f() is called once
+// before counting so one-off setup (e.g. a reused buffer's first growth) isn't counted.
+template <typename F>
+void run_counted(const char *section, const char *variant, std::size_t size, F &&f) {
+    run(section, variant, size, f);
+    const allocation_count c = count_allocations(f);
+    const std::string name = std::string(variant) + "/" + std::to_string(size);
+    counter(section, name.c_str(), "allocations_per_iteration", static_cast<double>(c.allocations));
+    counter(section, name.c_str(), "bytes_per_iteration", static_cast<double>(c.bytes));
+}
+
+} // namespace bench
+
+void *operator new(std::size_t size) { return bench::detail::counted_alloc(size); }
+void *operator new[](std::size_t size) { return bench::detail::counted_alloc(size); }
+void *operator new(std::size_t size, std::align_val_t align) {
+    return bench::detail::counted_alloc(size, static_cast<std::size_t>(align));
+}
+void *operator new[](std::size_t size, std::align_val_t align) {
+    return bench::detail::counted_alloc(size, static_cast<std::size_t>(align));
+}
+void *operator new(std::size_t size, const std::nothrow_t &) noexcept {
+    try {
+        return bench::detail::counted_alloc(size);
+    } catch (...) {
+        return nullptr;
+    }
+}
+void *operator new[](std::size_t size, const std::nothrow_t &) noexcept {
+    try {
+        return bench::detail::counted_alloc(size);
+    } catch (...) {
+        return nullptr;
+    }
+}
+
+void operator delete(void *p) noexcept { std::free(p); }
+void operator delete[](void *p) noexcept { std::free(p); }
+void operator delete(void *p, std::size_t) noexcept { std::free(p); }
+void operator delete[](void *p, std::size_t) noexcept { std::free(p); }
+void operator delete(void *p, std::align_val_t) noexcept { std::free(p); }
+void operator delete[](void *p, std::align_val_t) noexcept { std::free(p); }
+void operator delete(void *p, std::size_t, std::align_val_t) noexcept { std::free(p); }
+void operator delete[](void *p, std::size_t, std::align_val_t) noexcept { std::free(p); }
@@ -0,0 +1,101 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Benchmark helpers
+//
+// Just enough to time the cheatsheet kernels without pulling in a benchmark library. Each bench/
+// file includes the cheatsheet it measures and prints one CSV row per (variant, size):
+//
+//   section,variant,size,ns_per_item
+//
+// which is the timings format tools/report.cpp reads. Anything else worth reporting (memory
+// footprint, counters) goes to stderr as section,variant,event,value rows, the report's counters
+// format, so `./scan_bench > timings.csv 2> counters.csv` captures both. Build a bench with e.g.
+//
+//   g++ -std=c++20 -O2 -march=native -pthread -o scan_bench bench/scan.cpp
+//
+// The best (minimum) sample is reported. Noise on a benchmark machine only ever makes a run
+// slower, so the minimum is the most repeatable estimate of what the code itself costs.
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+
+namespace bench {
+
+// Stops the compiler from discarding a result or assuming memory is unchanged between runs.
+template <typename T>
+inline void do_not_optimise(T const &value) {
+    asm volatile("" : : "r,m"(value) : "memory");
+}
+
+inline void clobber_memory() {
+    asm volatile("" : : : "memory");
+}
+
+// Hides which function a pointer refers to, so a call through it can't be inlined. Use it when
+// inlining into the benchmark loop changes how a kernel is compiled (e.g. whether it vectorises)
+// and we want to time the code as it's compiled on its own.
+template <typename F>
+F *opaque(F *f) {
+    asm volatile("" : "+r"(f));
+    return f;
+}
+
+// Calls f() in batches large enough that the clock overhead is negligible, for at least
+// min_time, and returns the fastest batch in nanoseconds per item.
+template <typename F>
+double measure(F &&f, std::size_t items,
+               std::chrono::nanoseconds min_time = std::chrono::milliseconds(200)) {
+    using clock = std::chrono::steady_clock;
+    constexpr auto min_batch = std::chrono::microseconds(50);
+
+    std::size_t batch = 1;
+    for (;;) {
+        const auto start = clock::now();
+        for (std::size_t i = 0; i < batch; ++i) {
+            f();
+            clobber_memory();
+        }
+        if (clock::now() - start >= min_batch) {
+            break;
+        }
+        batch *= 2;
+    }
+
+    double best = 1e300;
+    std::chrono::nanoseconds total{0};
+    for (int samples = 0; samples < 5 || total < min_time; ++samples) {
+        const auto start = clock::now();
+        for (std::size_t i = 0; i < batch; ++i) {
+            f();
+            clobber_memory();
+        }
+        const auto elapsed = clock::now() - start;
+        total += std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed);
+        best = std::min(best, std::chrono::duration<double, std::nano>(elapsed).count());
+    }
+    return best / static_cast<double>(batch * std::max<std::size_t>(items, 1));
+}
+
+inline void header() {
+    std::printf("section,variant,size,ns_per_item\n");
+}
+
+inline void print(const char *section, const char *variant, std::size_t size, double ns_per_item) {
+    std::printf("%s,%s,%zu,%.4f\n", section, variant, size, ns_per_item);
+    std::fflush(stdout);
+}
+
+inline void counter(const char *section, const char *variant, const char *event, double value) {
+    std::fprintf(stderr, "%s,%s,%s,%.6g\n", section, variant, event, value);
+}
+
+template <typename F>
+void run(const char *section, const char *variant, std::size_t size, F &&f) {
+    print(section, variant, size, measure(f, size));
+}
+
+} // namespace bench
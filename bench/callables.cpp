@@ -0,0 +1,136 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Benchmarks for callables.cpp
+//
+//   g++ -std=c++20 -O3 -march=native -o callables_bench bench/callables.cpp
+//
+// -O3 because at -O2 GCC 12 vectorises none of these loops, with or without the callable
+// inlined. Every loop is called through bench::opaque so it's timed as compiled on its own, with
+// the callable passed in at run time, except combine_2_plus which shows the pointer being
+// propagated when the loop is inlined into a caller that passes a constant.
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include "../callables.cpp"
+
+#include "bench.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <random>
+#include <vector>
+
+namespace {
+
+constexpr std::size_t n = 4096;
+
+int times_3_plus_1_fn(int i) {
+    return i * 3 + 1;
+}
+
+void check(const char *variant, const std::vector<int> &result, const std::vector<int> &expected) {
+    if (result != expected) {
+        std::fprintf(stderr, "%s: wrong result\n", variant);
+        std::exit(1);
+    }
+}
+
+void passing_callables() {
+    std::vector<int> expected(n);
+    for (std::size_t i = 0; i < n; ++i) {
+        expected[i] = static_cast<int>(i) * 3 + 1;
+    }
+
+    const auto g1 = bench::opaque(generate_1<times_3_plus_1>);
+    const auto g2 = bench::opaque(generate_2);
+    const auto g3 = bench::opaque(generate_3);
+    const auto g4 = bench::opaque(generate_4);
+    const std::function<int(int)> function = times_3_plus_1{};
+    const times_3_plus_1 object;
+    const function_ref<int(int)> ref = object;
+
+    std::vector<int> a(n);
+    g1(a.data(), n, times_3_plus_1{});
+    check("generate_1", a, expected);
+    std::fill(a.begin(), a.end(), 0);
+    g2(a.data(), n, times_3_plus_1_fn);
+    check("generate_2", a, expected);
+    std::fill(a.begin(), a.end(), 0);
+    g3(a.data(), n, function);
+    check("generate_3", a, expected);
+    std::fill(a.begin(), a.end(), 0);
+    g4(a.data(), n, ref);
+    check("generate_4", a, expected);
+
+    bench::run("passing_callables", "generate_1 template", n, [&] { g1(a.data(), n, times_3_plus_1{}); });
+    bench::run("passing_callables", "generate_2 function pointer", n,
+               [&] { g2(a.data(), n, times_3_plus_1_fn); });
+    bench::run("passing_callables", "generate_3 std::function", n, [&] { g3(a.data(), n, function); });
+    bench::run("passing_callables", "generate_4 function_ref", n, [&] { g4(a.data(), n, ref); });
+}
+
+void two_inputs() {
+    std::mt19937 rng(42);
+    std::uniform_int_distribution<int> value(-1000, 1000);
+    std::vector<int> a0(n), b0(n), c(n);
+    for (std::size_t i = 0; i < n; ++i) {
+        a0[i] = value(rng);
+        b0[i] = value(rng);
+        c[i] = value(rng);
+    }
+    std::vector<int> a_expected = a0, b_expected = b0;
+    for (std::size_t i = 0; i < n; ++i) {
+        b_expected[i] += c[i];
+        a_expected[i] += b_expected[i];
+    }
+
+    const auto c1 = bench::opaque(combine_1<std::plus<>>);
+    const auto c2 = bench::opaque(combine_2);
+    const auto c3 = bench::opaque(combine_3);
+    const auto c4 = bench::opaque(combine_4);
+    const auto c2_plus = bench::opaque(combine_2_plus);
+    const std::function<int(int, int)> function = std::plus<>{};
+    const std::plus<> object;
+    const function_ref<int(int, int)> ref = object;
+
+    std::vector<int> a = a0, b = b0;
+    const auto reset_and_check = [&](const char *variant) {
+        check(variant, a, a_expected);
+        check(variant, b, b_expected);
+        a = a0;
+        b = b0;
+    };
+    c1(a.data(), b.data(), c.data(), n, std::plus<>{});
+    reset_and_check("combine_1");
+    c2(a.data(), b.data(), c.data(), n, plus);
+    reset_and_check("combine_2");
+    c3(a.data(), b.data(), c.data(), n, function);
+    reset_and_check("combine_3");
+    c4(a.data(), b.data(), c.data(), n, ref);
+    reset_and_check("combine_4");
+    c2_plus(a.data(), b.data(), c.data(), n);
+    reset_and_check("combine_2_plus");
+
+    // timed on zeros: with anything else a and b grow every call until they overflow, and the
+    // work doesn't depend on the values
+    std::fill(b.begin(), b.end(), 0);
+    std::fill(c.begin(), c.end(), 0);
+    bench::run("passing_callables_with_two_inputs", "combine_1 template", n,
+               [&] { c1(a.data(), b.data(), c.data(), n, std::plus<>{}); });
+    bench::run("passing_callables_with_two_inputs", "combine_2 function pointer", n,
+               [&] { c2(a.data(), b.data(), c.data(), n, plus); });
+    bench::run("passing_callables_with_two_inputs", "combine_3 std::function", n,
+               [&] { c3(a.data(), b.data(), c.data(), n, function); });
+    bench::run("passing_callables_with_two_inputs", "combine_4 function_ref", n,
+               [&] { c4(a.data(), b.data(), c.data(), n, ref); });
+    bench::run("passing_callables_with_two_inputs", "combine_2_plus", n,
+               [&] { c2_plus(a.data(), b.data(), c.data(), n); });
+}
+
+} // namespace
+
+int main() {
+    bench::header();
+    passing_callables();
+    two_inputs();
+    return 0;
+}
@@ -0,0 +1,131 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Benchmarks for code_size.cpp
+//
+//   g++ -std=c++20 -O2 -march=native -o code_size_bench bench/code_size.cpp
+//
+// "crc_streams<U>" is one kernel hashing a 64KB buffer: the speed unrolling buys. "x128" calls
+// 128 copies of the same kernel in turn on a 512 byte buffer each, so the hot set is 128 times
+// the kernel's size - from 4KB at U = 1 to 240KB at U = 32 - and counts L1 i-cache and iTLB
+// misses per word hashed (stderr, see perf_events.h).
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include "../code_size.cpp"
+
+#include "bench.h"
+#include "perf_events.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <utility>
+#include <vector>
+
+#if defined(__SSE4_2__)
+namespace {
+
+constexpr std::size_t copy_count = 128;
+constexpr std::size_t copy_words = 64;
+
+// Same definition as crc_streams<U>, written plainly.
+std::uint64_t reference(const std::uint64_t *data, std::size_t n, int streams) {
+    std::vector<std::uint64_t> crc(streams);
+    for (int u = 0; u < streams; ++u) {
+        crc[u] = u;
+    }
+    const std::size_t full = n - n % streams;
+    for (std::size_t i = 0; i < n; ++i) {
+        const std::size_t u = i < full ? i % streams : 0;
+        crc[u] = _mm_crc32_u64(crc[u], data[i]);
+    }
+    std::uint64_t hash = 0;
+    for (int u = 0; u < streams; ++u) {
+        hash = hash * 31 + crc[u];
+    }
+    return hash;
+}
+
+// A separate copy of crc_streams<U> per Copy. flatten inlines the kernel into each one, rather
+// than every copy calling the one explicit instantiation.
+template <int U, std::size_t Copy>
+[[gnu::flatten]] [[gnu::noinline]] std::uint64_t crc_copy(const std::uint64_t *data, std::size_t n) {
+    return crc_streams<U>(data, n) + Copy;
+}
+
+// Calls every copy once, each on its own part of data, through bench::opaque so none are inlined.
+template <int U, std::size_t... Copy>
+std::uint64_t run_copies(const std::uint64_t *data, std::index_sequence<Copy...>) {
+    std::uint64_t sum = 0;
+    ((sum += bench::opaque(crc_copy<U, Copy>)(data + Copy * copy_words, copy_words)), ...);
+    return sum;
+}
+
+template <int U>
+void unroll_factor(const std::vector<std::uint64_t> &data) {
+    std::uint64_t expected = 0;
+    for (std::size_t c = 0; c < copy_count; ++c) {
+        expected += reference(data.data() + c * copy_words, copy_words, U) + c;
+    }
+    const auto all = [&] { return run_copies<U>(data.data(), std::make_index_sequence<copy_count>()); };
+    if (crc_streams<U>(data.data(), data.size()) != reference(data.data(), data.size(), U) ||
+        crc_streams<U>(data.data(), data.size() - 3) != reference(data.data(), data.size() - 3, U) ||
+        all() != expected) {
+        std::fprintf(stderr, "crc_streams<%d>: wrong result\n", U);
+        std::exit(1);
+    }
+
+    char variant[64];
+    std::snprintf(variant, sizeof(variant), "crc_streams<%d>", U);
+    const auto kernel = bench::opaque(crc_streams<U>);
+    bench::run("unroll_factor", variant, data.size(),
+               [&] { bench::do_not_optimise(kernel(data.data(), data.size())); });
+
+    std::snprintf(variant, sizeof(variant), "crc_streams<%d> x%zu", U, copy_count);
+    bench::run_with_events("unroll_factor", variant, copy_count * copy_words,
+                           [&] { bench::do_not_optimise(all()); }, {bench::l1i_misses, bench::itlb_misses});
+}
+
+template <std::size_t N>
+void specialising_for_size(const std::vector<std::uint64_t> &data) {
+    if (crc_fixed<N>(data.data()) != reference(data.data(), N, 4) ||
+        crc_dispatch(data.data(), N) != reference(data.data(), N, 4)) {
+        std::fprintf(stderr, "crc_fixed<%zu>: wrong result\n", N);
+        std::exit(1);
+    }
+    const auto fixed = bench::opaque(crc_fixed<N>);
+    const auto generic = bench::opaque(crc_streams<4>);
+    const auto dispatch = bench::opaque(crc_dispatch);
+    bench::run("specialising_for_size", "crc_fixed<N>", N, [&] { bench::do_not_optimise(fixed(data.data())); });
+    bench::run("specialising_for_size", "crc_streams<4>", N,
+               [&] { bench::do_not_optimise(generic(data.data(), N)); });
+    bench::run("specialising_for_size", "crc_dispatch", N,
+               [&] { bench::do_not_optimise(dispatch(data.data(), N)); });
+}
+
+} // namespace
+#endif
+
+int main() {
+    bench::header();
+#if defined(__SSE4_2__)
+    std::mt19937_64 rng(42);
+    std::vector<std::uint64_t> data(copy_count * copy_words);
+    for (std::uint64_t &x : data) {
+        x = rng();
+    }
+
+    unroll_factor<1>(data);
+    unroll_factor<2>(data);
+    unroll_factor<4>(data);
+    unroll_factor<8>(data);
+    unroll_factor<16>(data);
+    unroll_factor<32>(data);
+
+    specialising_for_size<8>(data);
+    specialising_for_size<16>(data);
+    specialising_for_size<64>(data);
+    specialising_for_size<256>(data);
+#else
+    std::fprintf(stderr, "code_size.cpp needs SSE4.2 (build with -march=native)\n");
+#endif
+    return 0;
+}
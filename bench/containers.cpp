@@ -0,0 +1,70 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Benchmarks for containers.cpp
+//
+//   g++ -std=c++20 -O2 -march=native -o containers_bench bench/containers.cpp
+//
+// small_vector<int, 16> against std::vector<int> at sizes below, at and just past the inline
+// capacity. Times are per element.
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include "../branching.cpp"
+#include "../containers.cpp"
+
+#include "bench.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+namespace {
+
+template <typename Vector>
+int build_and_sum(std::size_t n) {
+    Vector v;
+    for (std::size_t i = 0; i < n; ++i) {
+        v.push_back(static_cast<int>(i));
+    }
+    int sum = 0;
+    for (int x : v) {
+        sum += x;
+    }
+    return sum;
+}
+
+// non-trivially copyable elements take the move-and-destroy path, check it round trips
+void check_strings() {
+    small_vector<std::string, 4> v;
+    for (int i = 0; i < 10; ++i) {
+        v.push_back(std::string(40, static_cast<char>('a' + i))); // too long for std::string's SSO
+    }
+    small_vector<std::string, 4> moved = std::move(v);
+    small_vector<std::string, 4> copied = moved;
+    for (int i = 0; i < 10; ++i) {
+        if (copied[i] != std::string(40, static_cast<char>('a' + i)) || !v.empty()) {
+            std::fprintf(stderr, "small_vector<std::string>: wrong result\n");
+            std::exit(1);
+        }
+    }
+}
+
+} // namespace
+
+int main() {
+    check_strings();
+    bench::header();
+
+    for (std::size_t n : {4, 16, 17, 64}) {
+        bench::run("small_buffer_optimisation", "std::vector/push_back", n,
+                   [&] { bench::do_not_optimise(build_and_sum<std::vector<int>>(n)); });
+        bench::run("small_buffer_optimisation", "small_vector/push_back", n,
+                   [&] { bench::do_not_optimise(build_and_sum<small_vector<int, 16>>(n)); });
+
+        std::vector<int> v(n, 1);
+        small_vector<int, 16> sv;
+        sv.resize(n);
+        bench::run("small_buffer_optimisation", "branch_while_2", n, [&] { branch_while_2(v); });
+        bench::run("small_buffer_optimisation", "branch_while_3", n, [&] { branch_while_3(sv); });
+    }
+    return 0;
+}
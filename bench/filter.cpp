@@ -0,0 +1,70 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Benchmarks for filter.cpp
+//
+//   g++ -std=c++20 -O2 -march=native -o filter_bench bench/filter.cpp
+//
+// 64K random ints in 0..99, filtered with limits from 1 to 99 so the limit is the selectivity
+// in %, appended to each variant. Every kernel is checked against std::copy_if.
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include "../filter.cpp"
+
+#include "bench.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+
+constexpr std::size_t n = std::size_t(1) << 16;
+
+using filter_fn = std::size_t (*)(const int *, std::size_t, int, int *);
+
+void run(const char *name, filter_fn fn, const std::vector<int> &in, int limit) {
+    std::string variant = name;
+    variant += " ";
+    variant += std::to_string(limit);
+    variant += "%";
+    std::vector<int> expected(n), out(n);
+    expected.resize(filter_copy_if(in.data(), n, limit, expected.data()));
+    const std::size_t count = fn(in.data(), n, limit, out.data());
+    out.resize(count);
+    if (out != expected) {
+        std::fprintf(stderr, "%s: wrong result\n", variant.c_str());
+        std::exit(1);
+    }
+    out.resize(n);
+    bench::run("stream_compaction", variant.c_str(), n,
+               [&] { bench::do_not_optimise(fn(in.data(), n, limit, out.data())); });
+}
+
+} // namespace
+
+int main() {
+    bench::header();
+    std::mt19937 rng(42);
+    std::uniform_int_distribution<int> value(0, 99);
+    std::vector<int> in(n);
+    for (auto &v : in) {
+        v = value(rng);
+    }
+
+    for (const int limit : {1, 5, 10, 25, 50, 75, 90, 95, 99}) {
+        run("filter_copy_if", bench::opaque(filter_copy_if), in, limit);
+        run("filter_branchless", bench::opaque(filter_branchless), in, limit);
+#if defined(__SSSE3__)
+        run("filter_sse", bench::opaque(filter_sse), in, limit);
+#endif
+#if defined(__AVX2__)
+        run("filter_avx2", bench::opaque(filter_avx2), in, limit);
+#endif
+#if defined(__AVX512F__)
+        run("filter_avx512", bench::opaque(filter_avx512), in, limit);
+        run("filter_avx512_compressstore", bench::opaque(filter_avx512_compressstore), in, limit);
+#endif
+    }
+    return 0;
+}
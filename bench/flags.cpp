@@ -0,0 +1,116 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Benchmarks for flags.cpp
+//
+//   g++ -std=c++20 -O3 -march=native -o flags_bench bench/flags.cpp
+//
+// Count and and-combine throughput per flag for 1M flags (fits in L2 once bit packed) and 64M
+// flags (DRAM for every representation). Bytes per flag go to stderr as counters.
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include "../flags.cpp"
+
+#include "bench.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+
+void check(const char *variant, std::size_t expected, std::size_t got) {
+    if (expected != got) {
+        std::fprintf(stderr, "%s: wrong result %zu, expected %zu\n", variant, got, expected);
+        std::exit(1);
+    }
+}
+
+// got against the flags combined one at a time
+template <typename Combine>
+void check_bits(const char *variant, const yes_no_bits &got, const std::vector<YesNo> &a,
+                const std::vector<YesNo> &b, Combine combine) {
+    for (std::size_t i = 0; i < a.size(); ++i) {
+        if (got.get(i) != combine(a[i] == YesNo::Yes, b[i] == YesNo::Yes)) {
+            std::fprintf(stderr, "%s: wrong flag %zu\n", variant, i);
+            std::exit(1);
+        }
+    }
+}
+
+void footprint(const char *variant, std::size_t n, std::size_t bytes) {
+    const std::string name = std::string(variant) + "/" + std::to_string(n);
+    bench::counter("bit_packed_flags", name.c_str(), "bytes_per_flag", static_cast<double>(bytes) / n);
+}
+
+} // namespace
+
+int main() {
+    bench::header();
+    std::mt19937 rng(42);
+
+    for (std::size_t n : {std::size_t(1) << 20, std::size_t(1) << 26}) {
+        std::vector<YesNo> a(n), b(n);
+        std::vector<YesNo8> a8(n);
+        yes_no_bits bits_a(n), bits_b(n);
+        for (std::size_t i = 0; i < n; ++i) {
+            a[i] = rng() & 1 ? YesNo::Yes : YesNo::No;
+            b[i] = rng() & 1 ? YesNo::Yes : YesNo::No;
+            a8[i] = a[i] == YesNo::Yes ? YesNo8::Yes : YesNo8::No;
+            bits_a.set(i, a[i]);
+            bits_b.set(i, b[i]);
+        }
+
+        const std::size_t expected = count_yes_1(a);
+        check("count_yes_2", expected, count_yes_2(a8));
+        check("yes_no_bits::count_yes", expected, bits_a.count_yes());
+        check("popcount_words_1", expected, popcount_words_1(bits_a.words(), bits_a.word_count()));
+
+        // called through opaque pointers: inlined into the timing loop, GCC vectorises one or the
+        // other depending on the surrounding code, which isn't what we want to compare
+        const auto count_32 = bench::opaque(count_yes_1);
+        const auto count_8 = bench::opaque(count_yes_2);
+        bench::run("enum_underlying_type", "count_yes_1", n, [&] { bench::do_not_optimise(count_32(a)); });
+        bench::run("enum_underlying_type", "count_yes_2", n, [&] { bench::do_not_optimise(count_8(a8)); });
+        bench::run("bit_packed_flags", "yes_no_bits::count_yes", n,
+                   [&] { bench::do_not_optimise(bits_a.count_yes()); });
+        bench::run("simd_popcount", "popcount_words_1", n, [&] {
+            bench::do_not_optimise(popcount_words_1(bits_a.words(), bits_a.word_count()));
+        });
+#if defined(__AVX2__)
+        check("popcount_words_avx2", expected, popcount_words_avx2(bits_a.words(), bits_a.word_count()));
+        bench::run("simd_popcount", "popcount_words_avx2", n, [&] {
+            bench::do_not_optimise(popcount_words_avx2(bits_a.words(), bits_a.word_count()));
+        });
+#endif
+#if defined(__AVX512VPOPCNTDQ__)
+        check("popcount_words_avx512", expected, popcount_words_avx512(bits_a.words(), bits_a.word_count()));
+        bench::run("simd_popcount", "popcount_words_avx512", n, [&] {
+            bench::do_not_optimise(popcount_words_avx512(bits_a.words(), bits_a.word_count()));
+        });
+#endif
+
+        // and-ing is idempotent, so repeating it in the timing loop doesn't change the work done
+        std::vector<YesNo> both = a;
+        and_yes_1(both, b);
+        yes_no_bits bits_both = bits_a;
+        bits_both &= bits_b;
+        check("yes_no_bits::operator&=", count_yes_1(both), bits_both.count_yes());
+        const auto yes = [](bool x) { return x ? YesNo::Yes : YesNo::No; };
+        check_bits("yes_no_bits::operator&=", bits_both, a, b, [&](bool x, bool y) { return yes(x && y); });
+        yes_no_bits bits_either = bits_a;
+        bits_either |= bits_b;
+        check_bits("yes_no_bits::operator|=", bits_either, a, b, [&](bool x, bool y) { return yes(x || y); });
+        yes_no_bits bits_only = bits_a;
+        bits_only.and_not(bits_b);
+        check_bits("yes_no_bits::and_not", bits_only, a, b, [&](bool x, bool y) { return yes(x && !y); });
+        const auto and_32 = bench::opaque(and_yes_1);
+        bench::run("enum_underlying_type", "and_yes_1", n, [&] { and_32(both, b); });
+        bench::run("bit_packed_flags", "yes_no_bits::operator&=", n, [&] { bits_both &= bits_b; });
+
+        footprint("std::vector<YesNo>", n, a.capacity() * sizeof(YesNo));
+        footprint("std::vector<YesNo8>", n, a8.capacity() * sizeof(YesNo8));
+        footprint("yes_no_bits", n, bits_a.memory());
+    }
+    return 0;
+}
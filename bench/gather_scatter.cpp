@@ -0,0 +1,135 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Benchmarks for gather_scatter.cpp
+//
+//   g++ -std=c++20 -O2 -march=native -o gather_scatter_bench bench/gather_scatter.cpp
+//
+// a[] is 64MB so random indices miss every cache level. Each kernel runs over three index
+// distributions: random, clustered (runs of 256 indices within a 16KB window) and sorted.
+// bucket_by_block's block is half of this machine's L2 (see topology.h). Every kernel's output,
+// and the pairs both reorderings produce, are checked against the scalar loops.
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include "../gather_scatter.cpp"
+
+#include "bench.h"
+#include "topology.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+
+constexpr std::size_t a_size = std::size_t(1) << 24;
+constexpr std::size_t n = std::size_t(1) << 22;
+
+std::vector<int> make_indices(const std::string &distribution, std::mt19937 &rng) {
+    std::vector<int> idx(n);
+    std::uniform_int_distribution<int> any(0, static_cast<int>(a_size) - 1);
+    if (distribution == "clustered") {
+        std::uniform_int_distribution<int> offset(0, 4095);
+        for (std::size_t i = 0; i < n; i += 256) {
+            const int base = std::min(any(rng), static_cast<int>(a_size) - 4096);
+            for (std::size_t j = i; j < std::min(n, i + 256); ++j) {
+                idx[j] = base + offset(rng);
+            }
+        }
+    } else {
+        for (auto &v : idx) {
+            v = any(rng);
+        }
+        if (distribution == "sorted") {
+            std::sort(idx.begin(), idx.end());
+        }
+    }
+    return idx;
+}
+
+void check(const std::string &variant, const std::vector<int> &expected, const std::vector<int> &got) {
+    if (expected != got) {
+        std::fprintf(stderr, "%s: wrong result\n", variant.c_str());
+        std::exit(1);
+    }
+}
+
+using gather_fn = void (*)(const int *, const int *, const int *, int *, std::size_t);
+
+void gather(const std::string &variant, gather_fn fn, const std::vector<int> &a, const std::vector<int> &idx,
+            const std::vector<int> &b, std::vector<int> &c, const std::vector<int> &expected) {
+    std::fill(c.begin(), c.end(), 0);
+    fn(a.data(), idx.data(), b.data(), c.data(), n);
+    check(variant, expected, c);
+    bench::run("indirect_access", variant.c_str(), n, [&] { fn(a.data(), idx.data(), b.data(), c.data(), n); });
+}
+
+} // namespace
+
+int main() {
+    bench::header();
+    std::mt19937 rng(42);
+    std::uniform_int_distribution<int> small(-4, 4);
+    const std::size_t block = bench::host().data_cache_size(2) / 2 / sizeof(int);
+
+    std::vector<int> b(n), c(n), a(a_size, 0);
+    for (auto &v : b) {
+        v = small(rng);
+    }
+
+    for (const std::string distribution : {"random", "clustered", "sorted"}) {
+        const std::vector<int> idx = make_indices(distribution, rng);
+        const auto name = [&](const char *variant) { return std::string(variant) + "/" + distribution; };
+
+        std::vector<int> expected(a_size, 0);
+        scatter_add_1(expected.data(), idx.data(), b.data(), n);
+
+        std::fill(a.begin(), a.end(), 0);
+        bench::run("indirect_access", name("scatter_add_1").c_str(), n,
+                   [&] { scatter_add_1(a.data(), idx.data(), b.data(), n); });
+        // a[] now holds the scatter's sums, so the gathers read something other than zeros
+        std::vector<int> gathered(n);
+        for (std::size_t i = 0; i < n; ++i) {
+            gathered[i] = a[static_cast<std::size_t>(idx[i])] + b[i];
+        }
+        gather(name("gather_add_1"), gather_add_1, a, idx, b, c, gathered);
+#if defined(__AVX2__)
+        gather(name("gather_add_avx2"), gather_add_avx2, a, idx, b, c, gathered);
+#endif
+#if defined(__AVX512F__) && defined(__AVX512CD__)
+        gather(name("gather_add_avx512"), gather_add_avx512, a, idx, b, c, gathered);
+        std::fill(a.begin(), a.end(), 0);
+        scatter_add_avx512(a.data(), idx.data(), b.data(), n);
+        check(name("scatter_add_avx512"), expected, a);
+        bench::run("indirect_access", name("scatter_add_avx512").c_str(), n,
+                   [&] { scatter_add_avx512(a.data(), idx.data(), b.data(), n); });
+#endif
+
+        std::fill(a.begin(), a.end(), 0);
+        scatter_add_prefetch(a.data(), idx.data(), b.data(), n);
+        check(name("scatter_add_prefetch"), expected, a);
+        bench::run("prefetching_indirect_access", name("scatter_add_prefetch").c_str(), n,
+                   [&] { scatter_add_prefetch(a.data(), idx.data(), b.data(), n); });
+
+        std::vector<int> idx_out(n), b_out(n);
+        sort_by_index(idx.data(), b.data(), idx_out.data(), b_out.data(), n);
+        std::vector<int> idx_sorted = idx;
+        std::sort(idx_sorted.begin(), idx_sorted.end());
+        check(name("sort_by_index"), idx_sorted, idx_out);
+        std::fill(a.begin(), a.end(), 0);
+        scatter_add_1(a.data(), idx_out.data(), b_out.data(), n);
+        check(name("sort_by_index"), expected, a);
+        bench::run("reordering_indices_for_locality", name("sort_by_index").c_str(), n,
+                   [&] { sort_by_index(idx.data(), b.data(), idx_out.data(), b_out.data(), n); });
+        bench::run("reordering_indices_for_locality", name("bucket_by_block").c_str(), n, [&] {
+            bucket_by_block(idx.data(), b.data(), idx_out.data(), b_out.data(), n, a_size, block);
+        });
+        std::fill(a.begin(), a.end(), 0);
+        scatter_add_1(a.data(), idx_out.data(), b_out.data(), n);
+        check(name("bucket_by_block"), expected, a);
+        bench::run("reordering_indices_for_locality", name("scatter_add_1 (bucketed)").c_str(), n,
+                   [&] { scatter_add_1(a.data(), idx_out.data(), b_out.data(), n); });
+    }
+    return 0;
+}
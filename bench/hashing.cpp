@@ -0,0 +1,158 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Benchmarks for hashing.cpp
+//
+//   g++ -std=c++20 -O2 -march=native -o hashing_bench bench/hashing.cpp
+//
+// Lookup throughput for keys that are in the table (hit) and keys that aren't (miss), looked up
+// in random order, plus the memory each table uses per element (as counters on stderr). Sizes are
+// deliberately not powers of two so the tables aren't all sitting just after a resize.
+// unordered_map bytes are what it asked the allocator for, malloc's own overhead comes on top.
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include "../hashing.cpp"
+
+#include "bench.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace {
+
+// Counts the bytes std::unordered_map asks for, so its footprint can be compared with the flat
+// tables which know their own size.
+std::size_t allocated_bytes = 0;
+
+template <typename T>
+struct counting_allocator {
+    using value_type = T;
+
+    counting_allocator() = default;
+    template <typename U>
+    counting_allocator(const counting_allocator<U> &) {}
+
+    T *allocate(std::size_t n) {
+        allocated_bytes += n * sizeof(T);
+        return std::allocator<T>{}.allocate(n);
+    }
+    void deallocate(T *p, std::size_t n) {
+        allocated_bytes -= n * sizeof(T);
+        std::allocator<T>{}.deallocate(p, n);
+    }
+
+    friend bool operator==(const counting_allocator &, const counting_allocator &) { return true; }
+};
+
+using std_map = std::unordered_map<std::uint64_t, std::uint64_t, std::hash<std::uint64_t>,
+                                   std::equal_to<std::uint64_t>,
+                                   counting_allocator<std::pair<const std::uint64_t, std::uint64_t>>>;
+
+std::uint64_t lookup(const std_map &map, std::uint64_t key) {
+    const auto it = map.find(key);
+    return it == map.end() ? 0 : it->second;
+}
+
+template <typename Map>
+std::uint64_t lookup(const Map &map, std::uint64_t key) {
+    const std::uint64_t *value = map.find(key);
+    return value == nullptr ? 0 : *value;
+}
+
+template <typename Map>
+void run(const char *section, const char *variant, Map &map, std::size_t memory,
+         const std::vector<std::uint64_t> &hits, const std::vector<std::uint64_t> &misses) {
+    const std::size_t n = hits.size();
+    std::uint64_t expected = 0;
+    for (std::uint64_t key : hits) {
+        expected += key;
+    }
+    std::uint64_t got = 0;
+    for (std::uint64_t key : hits) {
+        got += lookup(map, key);
+    }
+    for (std::uint64_t key : misses) {
+        got += lookup(map, key);
+    }
+    if (got != expected) {
+        std::fprintf(stderr, "%s: wrong result\n", variant);
+        std::exit(1);
+    }
+
+    const std::string hit = std::string(variant) + "/hit";
+    const std::string miss = std::string(variant) + "/miss";
+    bench::run(section, hit.c_str(), n, [&] {
+        std::uint64_t sum = 0;
+        for (std::uint64_t key : hits) {
+            sum += lookup(map, key);
+        }
+        bench::do_not_optimise(sum);
+    });
+    bench::run(section, miss.c_str(), n, [&] {
+        std::uint64_t sum = 0;
+        for (std::uint64_t key : misses) {
+            sum += lookup(map, key);
+        }
+        bench::do_not_optimise(sum);
+    });
+    const std::string size = std::to_string(n);
+    bench::counter(section, (std::string(variant) + "/" + size).c_str(), "bytes_per_element",
+                   static_cast<double>(memory) / static_cast<double>(n));
+}
+
+} // namespace
+
+int main() {
+    bench::header();
+    std::mt19937_64 rng(42);
+
+    for (std::size_t n : {1000, 50000, 800000, 6000000}) {
+        std::vector<std::uint64_t> hits(n), misses(n);
+        for (auto &k : hits) {
+            k = rng() >> 1; // top bit clear
+        }
+        for (auto &k : misses) {
+            k = (rng() >> 1) | (std::uint64_t(1) << 63); // top bit set, never a hit
+        }
+
+        {
+            allocated_bytes = 0;
+            std_map map;
+            for (std::uint64_t k : hits) {
+                map.emplace(k, k);
+            }
+            std::shuffle(hits.begin(), hits.end(), rng);
+            run("linear_probing_hash_table", "std::unordered_map", map, allocated_bytes, hits, misses);
+        }
+        {
+            linear_map map;
+            for (std::uint64_t k : hits) {
+                map.insert(k, k);
+            }
+            std::shuffle(hits.begin(), hits.end(), rng);
+            run("linear_probing_hash_table", "linear_map", map, map.memory(), hits, misses);
+        }
+        {
+            swiss_map<group16> map;
+            for (std::uint64_t k : hits) {
+                map.insert(k, k);
+            }
+            std::shuffle(hits.begin(), hits.end(), rng);
+            run("simd_probed_hash_table", "swiss_map<group16>", map, map.memory(), hits, misses);
+        }
+#if defined(__AVX2__)
+        {
+            swiss_map<group32> map;
+            for (std::uint64_t k : hits) {
+                map.insert(k, k);
+            }
+            std::shuffle(hits.begin(), hits.end(), rng);
+            run("simd_probed_hash_table", "swiss_map<group32>", map, map.memory(), hits, misses);
+        }
+#endif
+    }
+    return 0;
+}
@@ -0,0 +1,107 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Benchmarks for histogram.cpp
+//
+//   g++ -std=c++20 -O2 -march=native -pthread -o histogram_bench bench/histogram.cpp
+//
+// Every kernel runs on 1M uint8 keys from three distributions, each variant suffixed with it:
+//  - uniform     0..255, neighbouring keys share a bin 1 time in 256
+//  - skewed      geometric with p = 0.5 (half the keys are 0, a quarter 1, ...), neighbours
+//                share a bin 1 time in 3
+//  - constant    every key the same bin, the one-bin histogram of ++count in branching.cpp
+// histogram_runs is timed on the sorted keys, i.e. histogram_sorted without the sort. The
+// parallel histogram uses one thread per physical core (see topology.h), reported as the threads
+// counter.
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include "../histogram.cpp"
+
+#include "bench.h"
+#include "topology.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+
+constexpr std::size_t n = std::size_t(1) << 20;
+
+std::vector<std::uint8_t> uniform_keys() {
+    std::mt19937 rng(42);
+    std::uniform_int_distribution<int> key(0, 255);
+    std::vector<std::uint8_t> keys(n);
+    for (auto &k : keys) {
+        k = static_cast<std::uint8_t>(key(rng));
+    }
+    return keys;
+}
+
+std::vector<std::uint8_t> skewed_keys() {
+    std::mt19937 rng(42);
+    std::geometric_distribution<int> key(0.5);
+    std::vector<std::uint8_t> keys(n);
+    for (auto &k : keys) {
+        k = static_cast<std::uint8_t>(std::min(key(rng), 255));
+    }
+    return keys;
+}
+
+std::vector<std::uint8_t> constant_keys() {
+    return std::vector<std::uint8_t>(n, 7);
+}
+
+using histogram_fn = void (*)(const std::uint8_t *, std::size_t, std::uint32_t *);
+
+void run(const char *section, const char *name, const char *distribution, histogram_fn fn,
+         const std::vector<std::uint8_t> &keys, const std::vector<std::uint32_t> &expected) {
+    std::string variant = name;
+    variant += " ";
+    variant += distribution;
+    std::vector<std::uint32_t> bins(histogram_bins, 0xdead);
+    fn(keys.data(), keys.size(), bins.data());
+    if (bins != expected) {
+        std::fprintf(stderr, "%s: wrong result\n", variant.c_str());
+        std::exit(1);
+    }
+    bench::run(section, variant.c_str(), keys.size(), [&] { fn(keys.data(), keys.size(), bins.data()); });
+}
+
+void run_distribution(const char *distribution, const std::vector<std::uint8_t> &keys) {
+    std::vector<std::uint32_t> expected(histogram_bins, 0);
+    for (const std::uint8_t k : keys) {
+        ++expected[k];
+    }
+    std::vector<std::uint8_t> sorted = keys;
+    std::sort(sorted.begin(), sorted.end());
+
+    run("histogram", "histogram_naive", distribution, bench::opaque(histogram_naive), keys, expected);
+    run("histogram", "histogram_privatised<2>", distribution, bench::opaque(histogram_privatised<2>), keys,
+        expected);
+    run("histogram", "histogram_privatised<4>", distribution, bench::opaque(histogram_privatised<4>), keys,
+        expected);
+    run("histogram", "histogram_privatised<8>", distribution, bench::opaque(histogram_privatised<8>), keys,
+        expected);
+    run("sort_based_histogram", "histogram_sorted", distribution, bench::opaque(histogram_sorted), keys,
+        expected);
+    run("sort_based_histogram", "histogram_runs", distribution, bench::opaque(histogram_runs), sorted, expected);
+    run("parallel_histogram", "histogram_parallel", distribution,
+        [](const std::uint8_t *in, std::size_t size, std::uint32_t *bins) {
+            histogram_parallel(in, size, bins, bench::host().physical_cores);
+        },
+        keys, expected);
+}
+
+} // namespace
+
+int main() {
+    bench::header();
+    bench::counter("parallel_histogram", "histogram_parallel", "threads",
+                   static_cast<double>(bench::host().physical_cores));
+    run_distribution("uniform", uniform_keys());
+    run_distribution("skewed", skewed_keys());
+    run_distribution("constant", constant_keys());
+    return 0;
+}
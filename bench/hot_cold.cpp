@@ -0,0 +1,85 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Benchmarks for hot_cold.cpp
+//
+//   g++ -std=c++20 -O2 -march=native -o hot_cold_bench bench/hot_cold.cpp
+//
+// Each variant instantiates its handler 1024 times and calls every one in turn, so the hot set is
+// 1024 functions. Times are per handler call. L1 i-cache, iTLB and branch misses per call go to
+// stderr as counters when perf events are available (see perf_events.h). This file takes a while
+// to compile.
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include "../hot_cold.cpp"
+
+#include "bench.h"
+#include "perf_events.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <utility>
+#include <vector>
+
+namespace {
+
+constexpr std::size_t handler_count = 1024;
+
+// Calls handler<0> ... handler<handler_count - 1> once each, in order, like a pipeline of stages.
+// Each call goes through bench::opaque so handlers can't be inlined into this function (the
+// tiny handle_4 always would be) and every call site predicts its one target perfectly.
+template <int (*...Handlers)(const request &)>
+[[gnu::noinline]] long run_all(const request *requests) {
+    long sum = 0;
+    std::size_t i = 0;
+    ((sum += bench::opaque(Handlers)(requests[i++])), ...);
+    return sum;
+}
+
+template <std::size_t... I>
+long run_all_1(const request *r, std::index_sequence<I...>) { return run_all<handle_1<I>...>(r); }
+template <std::size_t... I>
+long run_all_2(const request *r, std::index_sequence<I...>) { return run_all<handle_2<I>...>(r); }
+template <std::size_t... I>
+long run_all_3(const request *r, std::index_sequence<I...>) { return run_all<handle_3<I>...>(r); }
+template <std::size_t... I>
+long run_all_4(const request *r, std::index_sequence<I...>) { return run_all<handle_4<I>...>(r); }
+
+} // namespace
+
+int main() {
+    bench::header();
+
+    std::mt19937 rng(42);
+    std::uniform_int_distribution<int> value(0, 1000);
+    std::vector<request> requests(handler_count);
+    for (request &r : requests) {
+        r = {value(rng), value(rng)};
+    }
+
+    using runner = long (*)(const request *);
+    const std::pair<const char *, runner> variants[] = {
+        {"handle_1", [](const request *r) { return run_all_1(r, std::make_index_sequence<handler_count>()); }},
+        {"handle_2 [[unlikely]]", [](const request *r) { return run_all_2(r, std::make_index_sequence<handler_count>()); }},
+        {"handle_3 expect_with_probability", [](const request *r) { return run_all_3(r, std::make_index_sequence<handler_count>()); }},
+        {"handle_4 [[gnu::cold]]", [](const request *r) { return run_all_4(r, std::make_index_sequence<handler_count>()); }},
+    };
+
+    // the error path has to work too
+    requests[handler_count / 2].value = -1;
+    const long expected = variants[0].second(requests.data());
+    for (const auto &[variant, f] : variants) {
+        if (f(requests.data()) != expected || last_error.empty()) {
+            std::fprintf(stderr, "%s: wrong result\n", variant);
+            std::exit(1);
+        }
+        last_error.clear();
+    }
+    requests[handler_count / 2].value = 1;
+
+    for (const auto &[variant, f] : variants) {
+        bench::run_with_events("hot_cold_splitting", variant, handler_count,
+                               [&] { bench::do_not_optimise(f(requests.data())); },
+                               {bench::l1i_misses, bench::itlb_misses, bench::branch_misses});
+    }
+    return 0;
+}
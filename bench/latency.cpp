@@ -0,0 +1,154 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Benchmarks for latency.cpp
+//
+//   g++ -std=c++20 -O2 -march=native -o latency_bench bench/latency.cpp
+//
+// Chases a random cycle through buffers from 4KB to 256MB (8 times the L3 here), once with 4KB
+// pages and once with 2MB pages, one row per size. Times are ns per load. Then, as counters:
+//  - <level>_latency_ns: the median over the sizes that fit comfortably in each cache level
+//    (between twice the level below and half this one) and, for dram, over sizes of 4 times the
+//    last level and up
+//  - tlb_knee_bytes: the smallest size at which 4KB pages are 10% slower than 2MB pages
+//  - huge_page_fraction: how much of the 2MB page buffers the kernel actually backed with huge
+//    pages. Transparent huge pages are a request (madvise), not a guarantee
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include "../latency.cpp"
+
+#include "bench.h"
+#include "topology.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#if defined(__linux__)
+#include <sys/mman.h>
+#endif
+
+namespace {
+
+constexpr std::size_t huge_page = std::size_t(2) << 20;
+
+struct result {
+    std::size_t bytes;
+    double ns;
+};
+
+// AnonHugePages for the whole process, in bytes
+std::size_t anon_huge_pages() {
+    std::ifstream f("/proc/self/smaps_rollup");
+    std::string key;
+    std::size_t kb = 0;
+    while (f >> key) {
+        if (key == "AnonHugePages:") {
+            f >> kb;
+            return kb * 1024;
+        }
+    }
+    return 0;
+}
+
+// Sizes from 4KB to 256MB: powers of two and halfway between.
+std::vector<std::size_t> sizes() {
+    std::vector<std::size_t> result;
+    for (std::size_t size = 4096; size <= (std::size_t(256) << 20); size *= 2) {
+        result.push_back(size);
+        result.push_back(size + size / 2);
+    }
+    result.pop_back();
+    return result;
+}
+
+std::vector<result> sweep(bool huge, double &huge_fraction) {
+    const char *variant = huge ? "2MB pages" : "4KB pages";
+    std::vector<result> results;
+    std::size_t huge_bytes = 0, total_bytes = 0;
+    for (const std::size_t bytes : sizes()) {
+        const std::size_t allocated = (bytes + huge_page - 1) / huge_page * huge_page;
+        auto *nodes = static_cast<chase_node *>(std::aligned_alloc(huge_page, allocated));
+        if (nodes == nullptr) {
+            std::fprintf(stderr, "%s: can't allocate %zu bytes\n", variant, allocated);
+            std::exit(1);
+        }
+#if defined(__linux__) && defined(MADV_HUGEPAGE)
+        madvise(nodes, allocated, huge ? MADV_HUGEPAGE : MADV_NOHUGEPAGE);
+#endif
+        const std::size_t n = bytes / sizeof(chase_node);
+        const std::size_t before = anon_huge_pages();
+        make_cycle(nodes, n, 42);
+        if (huge) {
+            huge_bytes += std::min(allocated, anon_huge_pages() - std::min(before, anon_huge_pages()));
+            total_bytes += allocated;
+        }
+
+        // enough steps to go round the cycle and for the timer not to matter
+        const std::size_t steps = std::max<std::size_t>(n, 1 << 16);
+        const chase_node *p = nodes;
+        const double ns = bench::measure([&] { p = chase(p, steps); }, steps);
+        bench::do_not_optimise(p);
+        bench::print("pointer_chasing", variant, bytes, ns);
+        results.push_back({bytes, ns});
+        std::free(nodes);
+    }
+    huge_fraction = total_bytes ? static_cast<double>(huge_bytes) / static_cast<double>(total_bytes) : 0.0;
+    return results;
+}
+
+double median_between(const std::vector<result> &results, std::size_t low, std::size_t high) {
+    std::vector<double> ns;
+    for (const result &r : results) {
+        if (r.bytes >= low && r.bytes <= high) {
+            ns.push_back(r.ns);
+        }
+    }
+    if (ns.empty()) {
+        return 0.0;
+    }
+    std::sort(ns.begin(), ns.end());
+    return ns[ns.size() / 2];
+}
+
+void plateaus(const char *variant, const std::vector<result> &results) {
+    const bench::topology &t = bench::host();
+    std::size_t below = 0;
+    for (const bench::cache_level &c : t.caches) {
+        if (c.type == bench::cache_level::kind::instruction) {
+            continue;
+        }
+        const std::string event = "L" + std::to_string(c.level) + "_latency_ns";
+        const double ns = median_between(results, below * 2, c.size / 2);
+        if (ns > 0.0) {
+            bench::counter("pointer_chasing", variant, event.c_str(), ns);
+        }
+        below = c.size;
+    }
+    const double dram = median_between(results, t.last_level_size() * 4, ~std::size_t(0));
+    if (dram > 0.0) {
+        bench::counter("pointer_chasing", variant, "dram_latency_ns", dram);
+    }
+}
+
+} // namespace
+
+int main() {
+    bench::header();
+    double small_fraction = 0.0, huge_fraction = 0.0;
+    const std::vector<result> small = sweep(false, small_fraction);
+    const std::vector<result> huge = sweep(true, huge_fraction);
+
+    plateaus("4KB pages", small);
+    plateaus("2MB pages", huge);
+    bench::counter("pointer_chasing", "2MB pages", "huge_page_fraction", huge_fraction);
+    for (std::size_t i = 0; i < small.size() && i < huge.size(); ++i) {
+        if (small[i].ns > huge[i].ns * 1.1) {
+            const double bytes = static_cast<double>(small[i].bytes);
+            bench::counter("pointer_chasing", "4KB pages", "tlb_knee_bytes", bytes);
+            break;
+        }
+    }
+    return 0;
+}
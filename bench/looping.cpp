@@ -0,0 +1,92 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Benchmarks for looping.cpp
+//
+//   g++ -std=c++20 -O3 -march=native -o looping_bench bench/looping.cpp
+//
+// -O3 because at -O2 GCC 12 vectorises none of these loops, and scalar they run at 1 element
+// per cycle or slower whatever the working set: no knees to find.
+//
+// Every kernel is swept over working sets from 4KB to 4 times the last level cache (see
+// sweep.h), with the knees where it falls out of each cache level reported as counters. Times
+// are ns per element written (loop unrolling), per multiply-add of the inner loop (loop
+// interchange) and per element of a (data dependency). The working set is the bytes the kernel
+// touches: a for loop unrolling, c plus 4 rows of a and b for loop interchange (rows = 4, so the
+// sweep reaches large n without the n^3 work of a square product), and a, b and c for data
+// dependency.
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include "../looping.cpp"
+
+#include "bench.h"
+#include "sweep.h"
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+namespace {
+
+constexpr std::size_t rows = 4;
+
+void check(const char *variant, bool ok) {
+    if (!ok) {
+        std::fprintf(stderr, "%s: wrong result\n", variant);
+        std::exit(1);
+    }
+}
+
+using unroll_fn = void (*)(int *, std::size_t);
+
+void loop_unrolling(const char *variant, unroll_fn fn) {
+    bench::sweep("loop_unrolling", variant, [&](std::size_t bytes) {
+        std::vector<int> a(bytes / sizeof(int) / 4 * 4);
+        fn(a.data(), a.size());
+        check(variant, a.back() == static_cast<int>(a.size() - 1));
+        return bench::measure([&] { fn(a.data(), a.size()); }, a.size());
+    });
+}
+
+using interchange_fn = void (*)(int *, const int *, const int *, std::size_t, std::size_t);
+
+void loop_interchange(const char *variant, interchange_fn fn) {
+    bench::sweep("loop_interchange", variant, [&](std::size_t bytes) {
+        // c is n x n, a and b are rows x n
+        const double ints = static_cast<double>(bytes / sizeof(int));
+        const auto n = static_cast<std::size_t>((std::sqrt(4.0 * rows * rows + 4.0 * ints) - 2.0 * rows) / 2.0);
+        std::vector<int> a(rows * n, 0), b(rows * n, 1), c(n * n, 2);
+        fn(a.data(), b.data(), c.data(), rows, n);
+        check(variant, a.back() == static_cast<int>(3 * n));
+        // a keeps growing by 3n per call: fine for the few thousand calls a size is timed for
+        return bench::measure([&] { fn(a.data(), b.data(), c.data(), rows, n); }, rows * n * n);
+    });
+}
+
+using dependency_fn = int (*)(int *, int *, const int *, std::size_t);
+
+void data_dependency(const char *variant, dependency_fn fn) {
+    bench::sweep("data_dependency", variant, [&](std::size_t bytes) {
+        const std::size_t n = bytes / sizeof(int) / 3;
+        std::vector<int> a(n, 1), b(n, 2), c(n, 3);
+        fn(a.data(), b.data(), c.data(), n);
+        check(variant, a[n - 2] == 6 && b[n - 1] == 5);
+        // timed on zeros: with anything else a and b grow every call until they overflow
+        std::fill(a.begin(), a.end(), 0);
+        std::fill(b.begin(), b.end(), 0);
+        std::fill(c.begin(), c.end(), 0);
+        return bench::measure([&] { bench::do_not_optimise(fn(a.data(), b.data(), c.data(), n)); }, n);
+    });
+}
+
+} // namespace
+
+int main() {
+    bench::header();
+    loop_unrolling("loop_unrolling_1", bench::opaque(loop_unrolling_1));
+    loop_unrolling("loop_unrolling_2", bench::opaque(loop_unrolling_2));
+    loop_interchange("loop_interchange_1", bench::opaque(loop_interchange_1));
+    loop_interchange("loop_interchange_2", bench::opaque(loop_interchange_2));
+    data_dependency("data_dependancy_1", bench::opaque(data_dependancy_1));
+    data_dependency("data_dependancy_2", bench::opaque(data_dependancy_2));
+    return 0;
+}
@@ -0,0 +1,72 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Benchmarks for lto/
+//
+// Unlike the other benchmarks this one is linked with the code it measures rather than including
+// it, since the TU boundaries are the point:
+//
+//   g++ -std=c++20 -O2 -march=native -o lto_bench bench/lto.cpp lto/kernel.cpp lto/caller.cpp lto/dispatch.cpp
+//
+// and again with -flto, or run tools/lto.sh to build and run both (and ThinLTO with clang++).
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include "../lto/caller.h"
+#include "../lto/dispatch.h"
+
+#include "bench.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+int main(int argc, char **) {
+    bench::header();
+
+    constexpr std::size_t n = 4096;
+    std::mt19937 rng(42);
+    std::uniform_int_distribution<int> value(-2000, 2000);
+    std::vector<int> input(n);
+    for (int &x : input) {
+        x = value(rng);
+    }
+
+    struct variant {
+        const char *name;
+        stage s;
+        int factor;
+        YesNo clamp;
+    };
+    const variant variants[] = {
+        {"run_stage negate", stage::negate, -1, YesNo::No},
+        {"run_stage clamp", stage::clamp, 1, YesNo::Yes},
+        {"run_stage negate_and_clamp", stage::negate_and_clamp, -1, YesNo::Yes},
+    };
+
+    for (const variant &v : variants) {
+        std::vector<int> expected = input;
+        for (int &x : expected) {
+            x *= v.factor;
+            if (v.clamp == YesNo::Yes) {
+                x = std::clamp(x, 0, 1000);
+            }
+        }
+        std::vector<int> data = input;
+        run_stage(v.s, data);
+        if (data != expected) {
+            std::fprintf(stderr, "%s: wrong result\n", v.name);
+            std::exit(1);
+        }
+
+        // stages are applied over and over to the same data: negating is its own inverse and
+        // clamping is idempotent, so the values stay in range
+        bench::run("link_time_optimisation", v.name, n, [&] { run_stage(v.s, data); });
+    }
+
+    // a flag only known at run time (No unless there are arguments): LTO can still inline
+    // adjust, but not fold the flag
+    std::vector<int> data = input;
+    const YesNo clamp = argc > 1 ? YesNo::Yes : YesNo::No;
+    bench::run("link_time_optimisation", "adjust_all runtime flag", n, [&] { adjust_all(data, -1, clamp); });
+    return 0;
+}
@@ -0,0 +1,263 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Benchmarks for matrix.cpp
+//
+//   g++ -std=c++20 -O3 -march=native -o matrix_bench bench/matrix.cpp
+//
+// -O3 because at -O2 GCC 12 vectorises none of the loop orders. Each kernel runs on three views
+// of n x n matrices: layout_right and layout_left over their own buffers, and layout_stride
+// sub-matrices (the top left n x n of row-major 2n x 2n buffers), the same kernel source for all
+// three. Times are ns per multiply-add (n^3 per call).
+//
+// The Morton and tiled layouts section runs each kernel over all four layouts, with the tile side
+// for layout_tiled and matmul_blocked picked from the L1d size in bench/topology.h.
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include "../matrix.cpp"
+
+#include "bench.h"
+#include "topology.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+
+constexpr std::size_t n = 256;
+
+struct operands {
+    std::vector<int> a, b, c;
+};
+
+// b and c random, a zero. a and b get the same values in every layout, element for element.
+template <typename Matrix>
+operands make_operands(Matrix (*view)(std::vector<int> &)) {
+    operands o{std::vector<int>(4 * n * n), std::vector<int>(4 * n * n), std::vector<int>(4 * n * n)};
+    std::mt19937 rng(42);
+    std::uniform_int_distribution<int> value(-100, 100);
+    const Matrix b = view(o.b), c = view(o.c);
+    for (std::size_t i = 0; i < n; ++i) {
+        for (std::size_t j = 0; j < n; ++j) {
+            b(i, j) = value(rng);
+            c(i, j) = value(rng);
+        }
+    }
+    return o;
+}
+
+matrix_right view_right(std::vector<int> &v) {
+    return matrix_right(v.data(), n, n);
+}
+
+matrix_left view_left(std::vector<int> &v) {
+    return matrix_left(v.data(), n, n);
+}
+
+matrix_stride view_sub(std::vector<int> &v) {
+    return md::submdspan(matrix_right(v.data(), 2 * n, 2 * n), std::pair{std::size_t{0}, n},
+                         std::pair{std::size_t{0}, n});
+}
+
+using expected_type = std::vector<long long>;
+
+expected_type expected_product() {
+    operands o = make_operands(view_right);
+    const matrix_right b = view_right(o.b), c = view_right(o.c);
+    expected_type a(n * n);
+    for (std::size_t i = 0; i < n; ++i) {
+        for (std::size_t k = 0; k < n; ++k) {
+            for (std::size_t j = 0; j < n; ++j) {
+                a[i * n + j] += static_cast<long long>(b(i, k)) * c(k, j);
+            }
+        }
+    }
+    return a;
+}
+
+template <typename Matrix>
+void run_layout(const char *layout, Matrix (*view)(std::vector<int> &), const expected_type &expected) {
+    using kernel = void (*)(Matrix, Matrix, Matrix);
+    const std::pair<const char *, kernel> kernels[] = {
+        {"matmul_ijk", bench::opaque(static_cast<kernel>(matmul_ijk<Matrix, Matrix, Matrix>))},
+        {"matmul_ikj", bench::opaque(static_cast<kernel>(matmul_ikj<Matrix, Matrix, Matrix>))},
+        {"matmul_jki", bench::opaque(static_cast<kernel>(matmul_jki<Matrix, Matrix, Matrix>))},
+        {"matmul", bench::opaque(static_cast<kernel>(matmul<Matrix, Matrix, Matrix>))},
+    };
+    operands o = make_operands(view);
+    const Matrix a = view(o.a), b = view(o.b), c = view(o.c);
+    for (const auto &[name, fn] : kernels) {
+        const std::string variant = std::string(name) + " " + layout;
+        for (std::size_t i = 0; i < n; ++i) {
+            for (std::size_t j = 0; j < n; ++j) {
+                a(i, j) = 0;
+            }
+        }
+        fn(a, b, c);
+        for (std::size_t i = 0; i < n; ++i) {
+            for (std::size_t j = 0; j < n; ++j) {
+                if (a(i, j) != expected[i * n + j]) {
+                    std::fprintf(stderr, "%s: wrong result\n", variant.c_str());
+                    std::exit(1);
+                }
+            }
+        }
+    }
+    // timed on zeros: a accumulates every call and would overflow, and the work doesn't depend
+    // on the values
+    std::fill(o.b.begin(), o.b.end(), 0);
+    std::fill(o.c.begin(), o.c.end(), 0);
+    for (const auto &[name, fn] : kernels) {
+        const std::string variant = std::string(name) + " " + layout;
+        bench::run("matrix_views", variant.c_str(), n * n * n, [&] { fn(a, b, c); });
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Morton and tiled layouts
+
+constexpr std::size_t walk_n = 1024;
+constexpr std::size_t multiply_n = 512;
+
+// The largest power of 2 tile side with three int tiles (one each of a, b and c) in L1d.
+std::size_t tile_side() {
+    const std::size_t l1 = bench::host().data_cache_size(1);
+    std::size_t tile = 8;
+    while (3 * (2 * tile) * (2 * tile) * sizeof(int) <= l1) {
+        tile *= 2;
+    }
+    return tile;
+}
+
+template <typename Matrix>
+struct storage {
+    std::vector<int> data;
+    Matrix view;
+};
+
+template <typename Matrix>
+storage<Matrix> make_matrix(const typename Matrix::mapping_type &m) {
+    storage<Matrix> s{std::vector<int>(m.required_span_size()), {}};
+    s.view = Matrix(s.data.data(), m);
+    return s;
+}
+
+void check(const char *variant, bool ok) {
+    if (!ok) {
+        std::fprintf(stderr, "%s: wrong result\n", variant);
+        std::exit(1);
+    }
+}
+
+template <typename Matrix>
+void fill(Matrix a, int lo, int hi, unsigned seed) {
+    std::mt19937 rng(seed);
+    std::uniform_int_distribution<int> value(lo, hi);
+    for (std::size_t i = 0; i < a.extent(0); ++i) {
+        for (std::size_t j = 0; j < a.extent(1); ++j) {
+            a(i, j) = value(rng);
+        }
+    }
+}
+
+// Runs every kernel on one layout; mapping(n) makes the layout's mapping for an n x n matrix.
+template <typename Matrix, typename MakeMapping>
+void run_storage_layout(const char *layout, MakeMapping mapping, std::size_t tile) {
+    const auto variant = [&](const char *kernel) { return std::string(kernel) + " " + layout; };
+    constexpr const char *section = "morton_and_tiled_layouts";
+
+    const auto rows = bench::opaque(static_cast<int (*)(Matrix)>(sum_rows<Matrix>));
+    const auto columns = bench::opaque(static_cast<int (*)(Matrix)>(sum_columns<Matrix>));
+    const auto flip = bench::opaque(static_cast<void (*)(Matrix, Matrix)>(transpose<Matrix, Matrix>));
+    const auto ikj = bench::opaque(static_cast<void (*)(Matrix, Matrix, Matrix)>(matmul_ikj<Matrix, Matrix, Matrix>));
+    const auto blocked = bench::opaque(
+        static_cast<void (*)(Matrix, Matrix, Matrix, std::size_t)>(matmul_blocked<Matrix, Matrix, Matrix>));
+
+    {
+        storage<Matrix> a = make_matrix<Matrix>(mapping(walk_n)), b = make_matrix<Matrix>(mapping(walk_n));
+        fill(a.view, 0, 3, 1);
+        int expected = 0;
+        std::mt19937 rng(1);
+        std::uniform_int_distribution<int> value(0, 3);
+        for (std::size_t i = 0; i < walk_n * walk_n; ++i) {
+            expected += value(rng);
+        }
+        check(variant("sum_rows").c_str(), rows(a.view) == expected);
+        check(variant("sum_columns").c_str(), columns(a.view) == expected);
+        flip(a.view, b.view);
+        bool transposed = true;
+        for (std::size_t i = 0; i < walk_n; ++i) {
+            for (std::size_t j = 0; j < walk_n; ++j) {
+                transposed &= b.view(j, i) == a.view(i, j);
+            }
+        }
+        check(variant("transpose").c_str(), transposed);
+
+        const std::size_t items = walk_n * walk_n;
+        bench::run(section, variant("sum_rows").c_str(), items, [&] { bench::do_not_optimise(rows(a.view)); });
+        bench::run(section, variant("sum_columns").c_str(), items, [&] { bench::do_not_optimise(columns(a.view)); });
+        bench::run(section, variant("transpose").c_str(), items, [&] { flip(a.view, b.view); });
+    }
+
+    storage<Matrix> a = make_matrix<Matrix>(mapping(multiply_n)), b = make_matrix<Matrix>(mapping(multiply_n)),
+                    c = make_matrix<Matrix>(mapping(multiply_n));
+    fill(b.view, -100, 100, 2);
+    fill(c.view, -100, 100, 3);
+    std::vector<long long> expected(multiply_n * multiply_n);
+    for (std::size_t i = 0; i < multiply_n; ++i) {
+        for (std::size_t k = 0; k < multiply_n; ++k) {
+            for (std::size_t j = 0; j < multiply_n; ++j) {
+                expected[i * multiply_n + j] += static_cast<long long>(b.view(i, k)) * c.view(k, j);
+            }
+        }
+    }
+    const auto check_product = [&](const char *kernel) {
+        bool ok = true;
+        for (std::size_t i = 0; i < multiply_n; ++i) {
+            for (std::size_t j = 0; j < multiply_n; ++j) {
+                ok &= a.view(i, j) == expected[i * multiply_n + j];
+                a.view(i, j) = 0;
+            }
+        }
+        check(variant(kernel).c_str(), ok);
+    };
+    ikj(a.view, b.view, c.view);
+    check_product("matmul_ikj");
+    blocked(a.view, b.view, c.view, tile);
+    check_product("matmul_blocked");
+
+    // timed on zeros, as in matrix_views
+    std::fill(b.data.begin(), b.data.end(), 0);
+    std::fill(c.data.begin(), c.data.end(), 0);
+    const std::size_t items = multiply_n * multiply_n * multiply_n;
+    bench::run(section, variant("matmul_ikj").c_str(), items, [&] { ikj(a.view, b.view, c.view); });
+    bench::run(section, variant("matmul_blocked").c_str(), items, [&] { blocked(a.view, b.view, c.view, tile); });
+}
+
+void morton_and_tiled_layouts() {
+    using extents = md::dextents<std::size_t, 2>;
+    const std::size_t tile = tile_side();
+    bench::counter("morton_and_tiled_layouts", "layout_tiled", "tile_side", static_cast<double>(tile));
+    run_storage_layout<matrix_right>(
+        "layout_right", [](std::size_t n) { return matrix_right::mapping_type(extents(n, n)); }, tile);
+    run_storage_layout<matrix_left>(
+        "layout_left", [](std::size_t n) { return matrix_left::mapping_type(extents(n, n)); }, tile);
+    run_storage_layout<matrix_tiled>(
+        "layout_tiled", [&](std::size_t n) { return matrix_tiled::mapping_type(extents(n, n), tile); }, tile);
+    run_storage_layout<matrix_morton>(
+        "layout_morton", [](std::size_t n) { return matrix_morton::mapping_type(extents(n, n)); }, tile);
+}
+
+} // namespace
+
+int main() {
+    bench::header();
+    const expected_type expected = expected_product();
+    run_layout("layout_right", view_right, expected);
+    run_layout("layout_left", view_left, expected);
+    run_layout("layout_stride", view_sub, expected);
+    morton_and_tiled_layouts();
+    return 0;
+}
@@ -0,0 +1,177 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Hardware event counters (Linux perf_event_open)
+//
+// Counts CPU events (cache and TLB misses, branch misses, instructions...) around a benchmark
+// without needing the perf tool. bench::run_with_events times f() like bench::run, then counts
+// the events over a further ~100ms of calls and reports each as a counter (stderr), per item:
+//
+//   section,variant/size,l1i_misses_per_item,N
+//
+// Events the kernel or CPU won't give us (no PMU in a VM, perf_event_paranoid too high, an
+// event the CPU doesn't have) are silently skipped, so a bench still runs everywhere; it just
+// reports fewer counters. If the PMU has fewer counters than events requested the kernel
+// multiplexes them and the counts are scaled by the fraction of time each was running.
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "bench.h"
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <initializer_list>
+#include <string>
+#include <vector>
+
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace bench {
+
+struct perf_event {
+    const char *name;
+    std::uint32_t type;
+    std::uint64_t config;
+};
+
+#if defined(__linux__)
+namespace detail {
+constexpr std::uint64_t cache_miss(std::uint64_t cache) {
+    return cache | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+}
+} // namespace detail
+
+inline constexpr perf_event instructions{"instructions", PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS};
+inline constexpr perf_event cycles{"cycles", PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES};
+inline constexpr perf_event branch_misses{"branch_misses", PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES};
+inline constexpr perf_event l1i_misses{"l1i_misses", PERF_TYPE_HW_CACHE, detail::cache_miss(PERF_COUNT_HW_CACHE_L1I)};
+inline constexpr perf_event l1d_misses{"l1d_misses", PERF_TYPE_HW_CACHE, detail::cache_miss(PERF_COUNT_HW_CACHE_L1D)};
+inline constexpr perf_event llc_misses{"llc_misses", PERF_TYPE_HW_CACHE, detail::cache_miss(PERF_COUNT_HW_CACHE_LL)};
+inline constexpr perf_event itlb_misses{"itlb_misses", PERF_TYPE_HW_CACHE, detail::cache_miss(PERF_COUNT_HW_CACHE_ITLB)};
+inline constexpr perf_event dtlb_misses{"dtlb_misses", PERF_TYPE_HW_CACHE, detail::cache_miss(PERF_COUNT_HW_CACHE_DTLB)};
+#else
+// Placeholders so benches that ask for events still build; perf_events never opens them here.
+inline constexpr perf_event instructions{"instructions", 0, 0};
+inline constexpr perf_event cycles{"cycles", 0, 0};
+inline constexpr perf_event branch_misses{"branch_misses", 0, 0};
+inline constexpr perf_event l1i_misses{"l1i_misses", 0, 0};
+inline constexpr perf_event l1d_misses{"l1d_misses", 0, 0};
+inline constexpr perf_event llc_misses{"llc_misses", 0, 0};
+inline constexpr perf_event itlb_misses{"itlb_misses", 0, 0};
+inline constexpr perf_event dtlb_misses{"dtlb_misses", 0, 0};
+#endif
+
+// A set of events counted together for this thread (user space only).
+class perf_events {
+public:
+    explicit perf_events(std::initializer_list<perf_event> events) {
+#if defined(__linux__)
+        for (const perf_event &e : events) {
+            perf_event_attr attr;
+            std::memset(&attr, 0, sizeof(attr));
+            attr.size = sizeof(attr);
+            attr.type = e.type;
+            attr.config = e.config;
+            attr.disabled = 1;
+            attr.exclude_kernel = 1;
+            attr.exclude_hv = 1;
+            attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+            const long fd = syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+            if (fd >= 0) {
+                open_.push_back({e, static_cast<int>(fd)});
+            }
+        }
+#else
+        (void)events;
+#endif
+    }
+
+    perf_events(const perf_events &) = delete;
+    perf_events &operator=(const perf_events &) = delete;
+
+    ~perf_events() {
+#if defined(__linux__)
+        for (const counter &c : open_) {
+            close(c.fd);
+        }
+#endif
+    }
+
+    bool empty() const { return open_.empty(); }
+
+    void start() {
+#if defined(__linux__)
+        for (const counter &c : open_) {
+            ioctl(c.fd, PERF_EVENT_IOC_RESET, 0);
+            ioctl(c.fd, PERF_EVENT_IOC_ENABLE, 0);
+        }
+#endif
+    }
+
+    void stop() {
+#if defined(__linux__)
+        for (const counter &c : open_) {
+            ioctl(c.fd, PERF_EVENT_IOC_DISABLE, 0);
+        }
+#endif
+    }
+
+    // (event, count) for each event that could be opened, scaled up if it was multiplexed
+    std::vector<std::pair<perf_event, double>> read() const {
+        std::vector<std::pair<perf_event, double>> values;
+#if defined(__linux__)
+        for (const counter &c : open_) {
+            std::uint64_t data[3] = {}; // value, time enabled, time running
+            if (::read(c.fd, data, sizeof(data)) != sizeof(data) || data[2] == 0) {
+                continue;
+            }
+            values.push_back({c.event, static_cast<double>(data[0]) * static_cast<double>(data[1]) /
+                                           static_cast<double>(data[2])});
+        }
+#endif
+        return values;
+    }
+
+private:
+    struct counter {
+        perf_event event;
+        int fd;
+    };
+    std::vector<counter> open_;
+};
+
+// bench::run, plus each event per item as counters.
+template <typename F>
+void run_with_events(const char *section, const char *variant, std::size_t size, F &&f,
+                     std::initializer_list<perf_event> events) {
+    run(section, variant, size, f);
+
+    perf_events counters(events);
+    if (counters.empty()) {
+        return;
+    }
+    using clock = std::chrono::steady_clock;
+    std::size_t calls = 0;
+    const auto start = clock::now();
+    counters.start();
+    do {
+        f();
+        clobber_memory();
+        ++calls;
+    } while (clock::now() - start < std::chrono::milliseconds(100));
+    counters.stop();
+
+    const std::string name = std::string(variant) + "/" + std::to_string(size);
+    const double items = static_cast<double>(calls) * static_cast<double>(size > 0 ? size : 1);
+    for (const auto &[event, count] : counters.read()) {
+        counter(section, name.c_str(), (std::string(event.name) + "_per_item").c_str(), count / items);
+    }
+}
+
+} // namespace bench
@@ -0,0 +1,145 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Benchmarks for quantised.cpp
+//
+//   g++ -std=c++20 -O3 -march=native -o quantised_bench bench/quantised.cpp
+//
+// -O3 because GCC 12 vectorises none of the scalar loops at -O2. Values are random in -127..127
+// (0..127 for the uint8 side), which keeps every kernel exact; each is checked against the
+// scalar int32 result. dot_u8i8_avx2 is also run with uint8 values over the full 0..255 range,
+// where pmaddubsw saturates, and reports how far off it is as the relative_error counter.
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include "../quantised.cpp"
+
+#include "bench.h"
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+namespace {
+
+constexpr std::size_t n = 4096;
+constexpr std::size_t m_rows = 256, n_cols = 256, k_depth = 1024;
+
+template <typename T>
+std::vector<T> random_values(std::size_t count, int lo, int hi, unsigned seed) {
+    std::mt19937 rng(seed);
+    std::uniform_int_distribution<int> value(lo, hi);
+    std::vector<T> v(count);
+    for (auto &x : v) {
+        x = static_cast<T>(value(rng));
+    }
+    return v;
+}
+
+template <typename T>
+std::vector<std::int32_t> widen(const std::vector<T> &v) {
+    return std::vector<std::int32_t>(v.begin(), v.end());
+}
+
+void check(const char *variant, bool ok) {
+    if (!ok) {
+        std::fprintf(stderr, "%s: wrong result\n", variant);
+        std::exit(1);
+    }
+}
+
+template <typename T, typename U>
+void run_dot(const char *variant, std::int32_t (*fn)(const T *, const U *, std::size_t), const std::vector<T> &a,
+             const std::vector<U> &b) {
+    fn = bench::opaque(fn);
+    const auto a32 = widen(a), b32 = widen(b);
+    check(variant, fn(a.data(), b.data(), n) == dot_i32(a32.data(), b32.data(), n));
+    bench::run("quantised_dot_products", variant, n, [&] { bench::do_not_optimise(fn(a.data(), b.data(), n)); });
+}
+
+void dot_products() {
+    const auto a32 = random_values<std::int32_t>(n, -127, 127, 1), b32 = random_values<std::int32_t>(n, -127, 127, 2);
+    const auto a16 = random_values<std::int16_t>(n, -127, 127, 1), b16 = random_values<std::int16_t>(n, -127, 127, 2);
+    const auto a8 = random_values<std::int8_t>(n, -127, 127, 1), b8 = random_values<std::int8_t>(n, -127, 127, 2);
+    const auto u8 = random_values<std::uint8_t>(n, 0, 127, 1);
+
+    run_dot("dot_i32", dot_i32, a32, b32);
+    run_dot("dot_i16", dot_i16, a16, b16);
+    run_dot("dot_i8", dot_i8, a8, b8);
+    run_dot("dot_u8i8", dot_u8i8, u8, b8);
+#if defined(__AVX2__)
+    run_dot("dot_i16_avx2", dot_i16_avx2, a16, b16);
+    run_dot("dot_i8_avx2", dot_i8_avx2, a8, b8);
+    run_dot("dot_u8i8_avx2", dot_u8i8_avx2, u8, b8);
+
+    const auto u8_full = random_values<std::uint8_t>(n, 0, 255, 3);
+    const double exact = dot_u8i8(u8_full.data(), b8.data(), n);
+    const double saturated = dot_u8i8_avx2(u8_full.data(), b8.data(), n);
+    bench::counter("quantised_dot_products", "dot_u8i8_avx2", "relative_error",
+                   std::abs(saturated - exact) / std::abs(exact));
+#endif
+#if defined(__AVX512VNNI__) && defined(__AVX512BW__)
+    run_dot("dot_i8_vnni", dot_i8_vnni, a8, b8);
+    run_dot("dot_u8i8_vnni", dot_u8i8_vnni, u8, b8);
+#endif
+}
+
+template <typename T>
+void run_matmul(const char *variant, void (*fn)(const T *, const T *, std::int32_t *, std::size_t, std::size_t,
+                                                  std::size_t),
+                const std::vector<std::int32_t> &expected) {
+    fn = bench::opaque(fn);
+    const auto a = random_values<T>(m_rows * k_depth, -127, 127, 4);
+    const auto bt = random_values<T>(n_cols * k_depth, -127, 127, 5);
+    std::vector<std::int32_t> c(m_rows * n_cols);
+    fn(a.data(), bt.data(), c.data(), m_rows, n_cols, k_depth);
+    check(variant, c == expected);
+    bench::run("quantised_matrix_multiply", variant, m_rows * n_cols * k_depth,
+               [&] { fn(a.data(), bt.data(), c.data(), m_rows, n_cols, k_depth); });
+}
+
+void matrix_multiply() {
+    std::vector<std::int32_t> expected(m_rows * n_cols);
+    {
+        const auto a = random_values<std::int32_t>(m_rows * k_depth, -127, 127, 4);
+        const auto bt = random_values<std::int32_t>(n_cols * k_depth, -127, 127, 5);
+        matmul_dot(a.data(), bt.data(), expected.data(), m_rows, n_cols, k_depth);
+    }
+    run_matmul("matmul_i32", matmul_i32, expected);
+    run_matmul("matmul_i16", matmul_i16, expected);
+    run_matmul("matmul_i8", matmul_i8, expected);
+#if defined(__AVX512VNNI__) && defined(__AVX512BW__)
+    {
+        const auto a = random_values<std::int8_t>(m_rows * k_depth, -127, 127, 4);
+        const auto bt = random_values<std::int8_t>(n_cols * k_depth, -127, 127, 5);
+        std::vector<std::int32_t> sums(n_cols), c(m_rows * n_cols);
+        column_sums(bt.data(), sums.data(), n_cols, k_depth);
+        const auto fn = bench::opaque(matmul_i8_vnni);
+        fn(a.data(), bt.data(), sums.data(), c.data(), m_rows, n_cols, k_depth);
+        check("matmul_i8_vnni", c == expected);
+        bench::run("quantised_matrix_multiply", "matmul_i8_vnni", m_rows * n_cols * k_depth,
+                   [&] { fn(a.data(), bt.data(), sums.data(), c.data(), m_rows, n_cols, k_depth); });
+    }
+#endif
+
+    std::vector<std::int8_t> out(m_rows * n_cols);
+    const float scale = 127.0f / (127.0f * 127.0f * 64.0f);
+    const auto rq = bench::opaque(requantise);
+    rq(expected.data(), out.data(), out.size(), scale);
+    bool ok = true;
+    for (std::size_t i = 0; i < out.size(); ++i) {
+        const double want = std::clamp(std::nearbyint(expected[i] * static_cast<double>(scale)), -128.0, 127.0);
+        ok &= std::abs(out[i] - want) <= 1.0;
+    }
+    check("requantise", ok);
+    bench::run("quantised_matrix_multiply", "requantise", out.size(),
+               [&] { rq(expected.data(), out.data(), out.size(), scale); });
+}
+
+} // namespace
+
+int main() {
+    bench::header();
+    dot_products();
+    matrix_multiply();
+    return 0;
+}
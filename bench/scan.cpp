@@ -0,0 +1,77 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Benchmarks for scan.cpp
+//
+//   g++ -std=c++20 -O2 -march=native -pthread -o scan_bench bench/scan.cpp -ltbb
+//
+// (drop -ltbb if the TBB headers are not installed, see "Standard library scan"). The parallel
+// scan uses one thread per physical core (see topology.h): SMT siblings share the core's load
+// and store units, which is what a scan is bound by.
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include "../scan.cpp"
+
+#include "bench.h"
+#include "topology.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+namespace {
+
+using scan_fn = void (*)(const int *, int *, std::size_t);
+
+void check(const char *variant, const std::vector<int> &expected, const std::vector<int> &got) {
+    if (expected != got) {
+        std::fprintf(stderr, "%s: wrong result\n", variant);
+        std::exit(1);
+    }
+}
+
+void run(const char *section, const char *variant, scan_fn fn, bool inclusive, const std::vector<int> &in) {
+    const std::size_t n = in.size();
+    std::vector<int> expected(n), out(n);
+    if (inclusive) {
+        scan_inclusive_1(in.data(), expected.data(), n);
+    } else {
+        scan_exclusive_1(in.data(), expected.data(), n);
+    }
+    fn(in.data(), out.data(), n);
+    check(variant, expected, out);
+    bench::run(section, variant, n, [&] { fn(in.data(), out.data(), n); });
+}
+
+} // namespace
+
+int main() {
+    bench::header();
+    std::mt19937 rng(42);
+    std::uniform_int_distribution<int> dist(-100, 100);
+
+    for (std::size_t n : {std::size_t(1) << 10, std::size_t(1) << 16, std::size_t(1) << 22}) {
+        std::vector<int> in(n);
+        for (auto &v : in) {
+            v = dist(rng);
+        }
+
+        run("prefix_sum", "scan_inclusive_1", scan_inclusive_1, true, in);
+        run("prefix_sum", "scan_exclusive_1", scan_exclusive_1, false, in);
+        run("simd_scan", "scan_inclusive_sse", scan_inclusive_sse, true, in);
+        run("simd_scan", "scan_exclusive_sse", scan_exclusive_sse, false, in);
+#if defined(__AVX2__)
+        run("simd_scan", "scan_inclusive_avx2", scan_inclusive_avx2, true, in);
+#endif
+        run("parallel_scan", "scan_inclusive_parallel",
+            [](const int *i, int *o, std::size_t s) {
+                scan_inclusive_parallel(i, o, s, bench::host().physical_cores);
+            },
+            true, in);
+        run("standard_library_scan", "scan_std_1", scan_std_1, true, in);
+        run("standard_library_scan", "scan_std_2", scan_std_2, true, in);
+        run("standard_library_scan", "scan_std_3", scan_std_3, true, in);
+        run("standard_library_scan", "scan_std_4", scan_std_4, true, in);
+        run("standard_library_scan", "scan_std_exclusive", scan_std_exclusive, false, in);
+    }
+    return 0;
+}
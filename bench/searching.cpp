@@ -0,0 +1,81 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Benchmarks for searching.cpp
+//
+//   g++ -std=c++20 -O2 -march=native -o searching_bench bench/searching.cpp
+//
+// Random lower_bound queries against arrays from 16KB (L1) to 256MB (DRAM). Queries are
+// independent, so this measures throughput: the CPU can overlap several searches at once.
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include "../searching.cpp"
+
+#include "bench.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <limits>
+#include <random>
+#include <vector>
+
+namespace {
+
+constexpr std::size_t queries = std::size_t(1) << 16;
+
+int value_or_max(const int *it, const std::vector<int> &sorted) {
+    return it == sorted.data() + sorted.size() ? std::numeric_limits<int>::max() : *it;
+}
+
+template <typename F>
+void run(const char *section, const char *variant, std::size_t n, const std::vector<int> &q,
+         const std::vector<int> &expected, F search) {
+    for (std::size_t i = 0; i < q.size(); ++i) {
+        if (search(q[i]) != expected[i]) {
+            std::fprintf(stderr, "%s: wrong result for %d\n", variant, q[i]);
+            std::exit(1);
+        }
+    }
+    // the size is the array length, but the time is per query
+    const double ns = bench::measure([&] {
+        int sum = 0;
+        for (int v : q) {
+            sum += search(v);
+        }
+        bench::do_not_optimise(sum);
+    }, q.size());
+    bench::print(section, variant, n, ns);
+}
+
+} // namespace
+
+int main() {
+    bench::header();
+    std::mt19937 rng(42);
+    std::uniform_int_distribution<int> dist(0, std::numeric_limits<int>::max() - 1);
+
+    for (std::size_t n : {std::size_t(1) << 12, std::size_t(1) << 15, std::size_t(1) << 20,
+                          std::size_t(1) << 23, std::size_t(1) << 26}) {
+        std::vector<int> sorted(n);
+        for (auto &v : sorted) {
+            v = dist(rng);
+        }
+        std::sort(sorted.begin(), sorted.end());
+        std::vector<int> q(queries), expected(queries);
+        for (std::size_t i = 0; i < queries; ++i) {
+            q[i] = dist(rng);
+            expected[i] = value_or_max(lower_bound_1(sorted.data(), n, q[i]), sorted);
+        }
+
+        run("branchless_binary_search", "lower_bound_1", n, q, expected,
+            [&](int v) { return value_or_max(lower_bound_1(sorted.data(), n, v), sorted); });
+        run("branchless_binary_search", "lower_bound_2", n, q, expected,
+            [&](int v) { return value_or_max(lower_bound_2(sorted.data(), n, v), sorted); });
+        run("branchless_binary_search", "lower_bound_3", n, q, expected,
+            [&](int v) { return value_or_max(lower_bound_3(sorted.data(), n, v), sorted); });
+        const eytzinger_array eytzinger(sorted);
+        run("eytzinger_layout", "eytzinger_array", n, q, expected, [&](int v) { return eytzinger.lower_bound(v); });
+        const s_tree tree(sorted);
+        run("s_tree", "s_tree", n, q, expected, [&](int v) { return tree.lower_bound(v); });
+    }
+    return 0;
+}
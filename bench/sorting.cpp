@@ -0,0 +1,162 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Benchmarks for sorting.cpp
+//
+//   g++ -std=c++20 -O2 -march=native -o sorting_bench bench/sorting.cpp
+//
+// Every call first copies the unsorted input back over the buffer (a memcpy, small next to any
+// of the sorts), and the result is checked against std::sort. Branch misses per element go to
+// stderr when perf events are available (see perf_events.h).
+//
+// Inputs, 1M ints:
+//  - random          uniform over all ints
+//  - nearly sorted   ascending, then 1% of the elements swapped with a random other
+//  - few unique      uniform over 0..15
+// The sorting network section sorts the random input in independent runs of 8 to 64.
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include "../sorting.cpp"
+
+#include "bench.h"
+#include "perf_events.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+
+constexpr std::size_t n = std::size_t(1) << 20;
+
+void check(const std::string &variant, bool ok) {
+    if (!ok) {
+        std::fprintf(stderr, "%s: wrong result\n", variant.c_str());
+        std::exit(1);
+    }
+}
+
+std::vector<int> random_input() {
+    std::mt19937 rng(42);
+    std::uniform_int_distribution<int> value(INT_MIN, INT_MAX);
+    std::vector<int> in(n);
+    for (auto &v : in) {
+        v = value(rng);
+    }
+    return in;
+}
+
+std::vector<int> nearly_sorted_input() {
+    std::vector<int> in(n);
+    for (std::size_t i = 0; i < n; ++i) {
+        in[i] = static_cast<int>(i);
+    }
+    std::mt19937 rng(42);
+    std::uniform_int_distribution<std::size_t> index(0, n - 1);
+    for (std::size_t i = 0; i < n / 100; ++i) {
+        std::swap(in[index(rng)], in[index(rng)]);
+    }
+    return in;
+}
+
+std::vector<int> few_unique_input() {
+    std::mt19937 rng(42);
+    std::uniform_int_distribution<int> value(0, 15);
+    std::vector<int> in(n);
+    for (auto &v : in) {
+        v = value(rng);
+    }
+    return in;
+}
+
+using partition_fn = std::size_t (*)(int *, std::size_t, int);
+
+void branchless_partition(const char *variant, partition_fn fn, const std::vector<int> &in) {
+    std::vector<int> sorted = in;
+    std::nth_element(sorted.begin(), sorted.begin() + n / 2, sorted.end());
+    const int pivot = sorted[n / 2];
+    std::vector<int> a = in;
+    const std::size_t mid = fn(a.data(), n, pivot);
+    check(variant, mid == n / 2 && std::all_of(a.begin(), a.begin() + mid, [&](int x) { return x < pivot; }) &&
+                       std::all_of(a.begin() + mid, a.end(), [&](int x) { return x >= pivot; }));
+    bench::run_with_events(
+        "branchless_partition", variant, n,
+        [&] {
+            std::copy(in.begin(), in.end(), a.begin());
+            bench::do_not_optimise(fn(a.data(), n, pivot));
+        },
+        {bench::branch_misses});
+}
+
+using sort_fn = void (*)(int *, std::size_t);
+
+void sorting_networks(const char *name, sort_fn fn, const std::vector<int> &in, std::size_t run) {
+    const std::string variant = std::string(name) + " " + std::to_string(run);
+    const std::size_t total = n / 16 / run * run;
+    std::vector<int> expected(in.begin(), in.begin() + static_cast<std::ptrdiff_t>(total)), a = expected;
+    for (std::size_t i = 0; i < total; i += run) {
+        std::sort(expected.begin() + static_cast<std::ptrdiff_t>(i), expected.begin() + static_cast<std::ptrdiff_t>(i + run));
+        fn(a.data() + i, run);
+    }
+    check(variant, a == expected);
+    bench::run_with_events(
+        "sorting_networks", variant.c_str(), total,
+        [&] {
+            std::copy(in.begin(), in.begin() + static_cast<std::ptrdiff_t>(total), a.begin());
+            for (std::size_t i = 0; i < total; i += run) {
+                fn(a.data() + i, run);
+            }
+        },
+        {bench::branch_misses});
+}
+
+void full_sort(const char *name, sort_fn fn, const char *input, const std::vector<int> &in) {
+    const std::string variant = std::string(name) + " " + input;
+    std::vector<int> expected = in, a = in;
+    std::sort(expected.begin(), expected.end());
+    fn(a.data(), n);
+    check(variant, a == expected);
+    bench::run_with_events(
+        "hybrid_sort", variant.c_str(), n,
+        [&] {
+            std::copy(in.begin(), in.end(), a.begin());
+            fn(a.data(), n);
+        },
+        {bench::branch_misses});
+}
+
+void std_sort(int *a, std::size_t size) {
+    std::sort(a, a + size);
+}
+
+void hybrid(int *a, std::size_t size) {
+    hybrid_sort(a, size);
+}
+
+} // namespace
+
+int main() {
+    bench::header();
+    const std::vector<int> random = random_input();
+
+    branchless_partition("partition_std", bench::opaque(partition_std), random);
+    branchless_partition("partition_lomuto_branchless", bench::opaque(partition_lomuto_branchless), random);
+    branchless_partition("partition_block", bench::opaque(partition_block), random);
+
+    for (const std::size_t run : {8, 16, 32, 64}) {
+        sorting_networks("std::sort", bench::opaque(std_sort), random, run);
+        sorting_networks("insertion_sort", bench::opaque(insertion_sort), random, run);
+#if defined(__AVX512F__)
+        sorting_networks("sort_network", bench::opaque(sort_network), random, run);
+#endif
+    }
+
+    const std::pair<const char *, std::vector<int>> inputs[] = {
+        {"random", random}, {"nearly_sorted", nearly_sorted_input()}, {"few_unique", few_unique_input()}};
+    for (const auto &[input, in] : inputs) {
+        full_sort("std::sort", bench::opaque(std_sort), input, in);
+        full_sort("hybrid_sort", bench::opaque(hybrid), input, in);
+    }
+    return 0;
+}
@@ -0,0 +1,198 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Benchmarks for sparse.cpp
+//
+//   g++ -std=c++20 -O2 -march=native -o sparse_bench bench/sparse.cpp
+//
+// Three synthetic 262144 x 262144 matrices, generated as COO and converted:
+//  - banded     16 nonzeros per row around the diagonal: x is read almost sequentially
+//  - random     16 nonzeros per row in random columns: every x read is a random access (x is
+//               1MB, so it stays in L2)
+//  - power-law  row lengths from a Pareto distribution (alpha 1.5, at least 4, averaging about
+//               12, the longest few thousand) in random columns, like a web or social graph
+// Times are ns per nonzero. Each variant also reports gflops (2 flops per nonzero) and
+// bytes_per_nonzero, the size of the matrix in that format over the number of nonzeros, as
+// counters. ELL is skipped where padding would make it more than 4x the CSR size. SELL sorts all
+// the rows by length (sigma = n): best here, where the columns are random anyway; a matrix with
+// locality to keep wants a smaller sigma. The power-law matrix is also run through
+// spmv_sell_avx2 at sigma = 8, 64, 1024 and n, the sigma table in sparse.cpp.
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include "../sparse.cpp"
+
+#include "bench.h"
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+
+constexpr std::size_t n = 262144;
+constexpr const char *section = "sparse_matrix_vector_product";
+
+coo_matrix banded() {
+    coo_matrix a{n, n, {}, {}, {}};
+    std::mt19937 rng(1);
+    std::uniform_real_distribution<float> value(-1.0f, 1.0f);
+    for (std::size_t r = 0; r < n; ++r) {
+        const std::size_t first = std::min(r < 8 ? 0 : r - 8, n - 16);
+        for (std::size_t c = first; c < first + 16; ++c) {
+            a.row.push_back(static_cast<std::uint32_t>(r));
+            a.col.push_back(static_cast<std::uint32_t>(c));
+            a.value.push_back(value(rng));
+        }
+    }
+    return a;
+}
+
+// length(r) nonzeros in row r, in random (sorted) columns.
+template <typename Length>
+coo_matrix random_columns(Length length, unsigned seed) {
+    coo_matrix a{n, n, {}, {}, {}};
+    std::mt19937 rng(seed);
+    std::uniform_int_distribution<std::uint32_t> column(0, n - 1);
+    std::uniform_real_distribution<float> value(-1.0f, 1.0f);
+    std::vector<std::uint32_t> cols;
+    for (std::size_t r = 0; r < n; ++r) {
+        cols.resize(length(rng));
+        for (auto &c : cols) {
+            c = column(rng);
+        }
+        std::sort(cols.begin(), cols.end());
+        for (const std::uint32_t c : cols) {
+            a.row.push_back(static_cast<std::uint32_t>(r));
+            a.col.push_back(c);
+            a.value.push_back(value(rng));
+        }
+    }
+    return a;
+}
+
+coo_matrix random_matrix() {
+    return random_columns([](std::mt19937 &) { return std::size_t{16}; }, 2);
+}
+
+coo_matrix power_law() {
+    return random_columns(
+        [](std::mt19937 &rng) {
+            std::uniform_real_distribution<double> u(0.0, 1.0);
+            const double length = 4.0 / std::pow(1.0 - u(rng), 1.0 / 1.5);
+            return static_cast<std::size_t>(std::min(length, static_cast<double>(n)));
+        },
+        3);
+}
+
+void check(const std::string &variant, const std::vector<float> &y, const std::vector<double> &expected) {
+    for (std::size_t r = 0; r < y.size(); ++r) {
+        if (std::abs(y[r] - expected[r]) > 1e-3 * (1.0 + std::abs(expected[r]))) {
+            std::fprintf(stderr, "%s: wrong result at row %zu\n", variant.c_str(), r);
+            std::exit(1);
+        }
+    }
+}
+
+template <typename Matrix>
+void run(const char *kernel, const char *matrix, void (*fn)(const Matrix &, const float *, float *),
+         const Matrix &a, std::size_t nonzeros, double bytes, const std::vector<float> &x,
+         const std::vector<double> &expected) {
+    const std::string variant = std::string(kernel) + " " + matrix;
+    std::vector<float> y(a.rows);
+    fn = bench::opaque(fn);
+    fn(a, x.data(), y.data());
+    check(variant, y, expected);
+    const double ns = bench::measure([&] { fn(a, x.data(), y.data()); }, nonzeros);
+    bench::print(section, variant.c_str(), nonzeros, ns);
+    bench::counter(section, variant.c_str(), "gflops", 2.0 / ns);
+    bench::counter(section, variant.c_str(), "bytes_per_nonzero", bytes / static_cast<double>(nonzeros));
+}
+
+std::vector<float> make_x() {
+    std::vector<float> x(n);
+    std::mt19937 rng(4);
+    std::uniform_real_distribution<float> value(-1.0f, 1.0f);
+    for (auto &v : x) {
+        v = value(rng);
+    }
+    return x;
+}
+
+// y = A x in double, summed in COO order.
+std::vector<double> reference(const coo_matrix &coo, const std::vector<float> &x) {
+    std::vector<double> expected(n, 0.0);
+    for (std::size_t i = 0; i < coo.value.size(); ++i) {
+        expected[coo.row[i]] += static_cast<double>(coo.value[i]) * x[coo.col[i]];
+    }
+    return expected;
+}
+
+double sell_bytes(const sell_matrix &sell) {
+    return 8.0 * static_cast<double>(sell.value.size()) + 4.0 * static_cast<double>(n) +
+           8.0 * static_cast<double>(sell.slice_start.size());
+}
+
+void run_matrix(const char *name, const coo_matrix &coo) {
+    const csr_matrix csr = to_csr(coo);
+    const std::size_t nonzeros = csr.value.size();
+    const std::vector<float> x = make_x();
+    const std::vector<double> expected = reference(coo, x);
+
+    const double csr_bytes = 8.0 * static_cast<double>(nonzeros) + 4.0 * static_cast<double>(n + 1);
+    run("spmv_csr", name, spmv_csr, csr, nonzeros, csr_bytes, x, expected);
+#if defined(__AVX2__)
+    run("spmv_csr_avx2", name, spmv_csr_avx2, csr, nonzeros, csr_bytes, x, expected);
+#endif
+
+    std::size_t width = 0;
+    for (std::size_t r = 0; r < n; ++r) {
+        width = std::max<std::size_t>(width, csr.row_start[r + 1] - csr.row_start[r]);
+    }
+    const double ell_bytes = 8.0 * static_cast<double>(width * n);
+    if (ell_bytes <= 4.0 * csr_bytes) {
+        const ell_matrix ell = to_ell(csr);
+        run("spmv_ell", name, spmv_ell, ell, nonzeros, ell_bytes, x, expected);
+#if defined(__AVX2__)
+        run("spmv_ell_avx2", name, spmv_ell_avx2, ell, nonzeros, ell_bytes, x, expected);
+#endif
+    } else {
+        bench::counter(section, (std::string("spmv_ell ") + name).c_str(), "bytes_per_nonzero",
+                       ell_bytes / static_cast<double>(nonzeros));
+    }
+
+    const sell_matrix sell = to_sell(csr, n);
+    run("spmv_sell", name, spmv_sell, sell, nonzeros, sell_bytes(sell), x, expected);
+#if defined(__AVX2__)
+    run("spmv_sell_avx2", name, spmv_sell_avx2, sell, nonzeros, sell_bytes(sell), x, expected);
+#endif
+}
+
+#if defined(__AVX2__)
+void sigma_sweep(const char *name, const coo_matrix &coo) {
+    const csr_matrix csr = to_csr(coo);
+    const std::size_t nonzeros = csr.value.size();
+    const std::vector<float> x = make_x();
+    const std::vector<double> expected = reference(coo, x);
+
+    for (const std::size_t sigma : {std::size_t{8}, std::size_t{64}, std::size_t{1024}, n}) {
+        const std::string matrix = std::string(name) + " sigma=" + std::to_string(sigma);
+        const sell_matrix sell = to_sell(csr, sigma);
+        run("spmv_sell_avx2", matrix.c_str(), spmv_sell_avx2, sell, nonzeros, sell_bytes(sell), x, expected);
+    }
+}
+#endif
+
+} // namespace
+
+int main() {
+    bench::header();
+    run_matrix("banded", banded());
+    run_matrix("random", random_matrix());
+    const coo_matrix skewed = power_law();
+    run_matrix("power-law", skewed);
+#if defined(__AVX2__)
+    sigma_sweep("power-law", skewed);
+#endif
+    return 0;
+}
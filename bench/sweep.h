@@ -0,0 +1,137 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Working set sweeps
+//
+// A kernel timed at one size says nothing about the sizes it wasn't timed at. bench::sweep runs
+// it over working sets from 4KB to 4 times the last level cache (from topology.h), two sizes per
+// octave, and prints one timings row per size with the size column in bytes of working set:
+//
+//   bench::sweep("loop_unrolling", "loop_unrolling_1", [&](std::size_t bytes) {
+//       std::vector<int> a(bytes / sizeof(int));
+//       return bench::measure([&] { loop_unrolling_1(a.data(), a.size()); }, a.size());
+//   });
+//
+// The callback sets up a working set of (about) the given size and returns ns per item. Then the
+// sweep finds the knees - where ns per item jumps by 20% or more from the plateau before it - and
+// names each after the cache level it falls out of, as counters (stderr):
+//
+//   loop_interchange,loop_interchange_1,knee_L2_bytes,262144
+//   loop_interchange,loop_interchange_1,knee_L2_slowdown,3.1
+//
+// knee_<level>_bytes is the last size before the jump: the largest working set that still ran at
+// the speed of the level. tools/report.cpp draws sections with sweeps as a throughput curve over
+// size with the knees marked. A level with no knee means the kernel doesn't care about it -
+// usually because the prefetchers keep up - which is as useful to know as where the knees are.
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "bench.h"
+#include "topology.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace bench {
+
+struct sweep_point {
+    std::size_t bytes;
+    double ns_per_item;
+};
+
+struct knee {
+    std::size_t bytes; // last size on the plateau
+    double slowdown;   // ns per item after the jump / on the plateau
+    std::string level; // "L1", "L2", ... or "past_L3"
+};
+
+// 4KB to max_bytes, two sizes per octave, rounded to 64 bytes.
+inline std::vector<std::size_t> working_set_sizes(std::size_t max_bytes = 4 * host().last_level_size()) {
+    std::vector<std::size_t> sizes;
+    for (std::size_t size = 4096; size <= max_bytes; size *= 2) {
+        sizes.push_back(size);
+        const auto between = static_cast<std::size_t>(static_cast<double>(size) * std::sqrt(2.0)) / 64 * 64;
+        if (between <= max_bytes) {
+            sizes.push_back(between);
+        }
+    }
+    return sizes;
+}
+
+// The smallest data cache level that bytes doesn't overflow by more than a factor of 2, or
+// "past_L<last>" beyond all of them. Knees rarely sit exactly on a cache size: associativity,
+// other data and the TLBs (see latency.cpp) move them.
+inline std::string nearest_level(std::size_t bytes, const topology &t) {
+    std::string name = "L";
+    int last = 0;
+    for (const cache_level &c : t.caches) {
+        if (c.type == cache_level::kind::instruction) {
+            continue;
+        }
+        if (bytes <= 2 * c.size) {
+            return name += std::to_string(c.level);
+        }
+        last = c.level;
+    }
+    return name.insert(0, "past_") += std::to_string(last);
+}
+
+// A knee starts where ns per item exceeds the current plateau by threshold at two sizes in a row
+// (one slow size is noise), and runs for as long as it keeps climbing (by 5% or more per step).
+// The end of one knee is the plateau for the next.
+inline std::vector<knee> find_knees(const std::vector<sweep_point> &points, const topology &t = host(),
+                                    double threshold = 1.2) {
+    std::vector<knee> knees;
+    if (points.empty()) {
+        return knees;
+    }
+    double plateau = points[0].ns_per_item;
+    for (std::size_t i = 1; i < points.size(); ++i) {
+        if (points[i].ns_per_item < plateau) {
+            plateau = points[i].ns_per_item; // the first few sizes are often slower (call overhead)
+            continue;
+        }
+        const bool next_slow = i + 1 == points.size() || points[i + 1].ns_per_item >= plateau * threshold;
+        if (points[i].ns_per_item < plateau * threshold || !next_slow) {
+            continue;
+        }
+        const std::size_t last_fast = points[i - 1].bytes;
+        while (i + 1 < points.size() && points[i + 1].ns_per_item > points[i].ns_per_item * 1.05) {
+            ++i;
+        }
+        knees.push_back({last_fast, points[i].ns_per_item / plateau, nearest_level(last_fast, t)});
+        plateau = points[i].ns_per_item;
+    }
+    return knees;
+}
+
+template <typename F>
+std::vector<knee> sweep(const char *section, const char *variant, F &&run,
+                        const std::vector<std::size_t> &sizes = working_set_sizes()) {
+    std::vector<sweep_point> points;
+    for (const std::size_t bytes : sizes) {
+        const double ns = run(bytes);
+        print(section, variant, bytes, ns);
+        points.push_back({bytes, ns});
+    }
+    const std::vector<knee> knees = find_knees(points);
+    for (std::size_t i = 0; i < knees.size(); ++i) {
+        const knee &k = knees[i];
+        // knee_L3, then knee_L3_2 if there's another one in the same level. Appended piece by piece:
+        // "_" + std::to_string(...) trips GCC 12's -Wrestrict at -O3
+        std::string name = "knee_";
+        name += k.level;
+        const auto same = std::count_if(knees.begin(), knees.begin() + i, [&](const knee &o) { return o.level == k.level; });
+        if (same > 0) {
+            name += '_';
+            name += std::to_string(same + 1);
+        }
+        counter(section, variant, (name + "_bytes").c_str(), static_cast<double>(k.bytes));
+        counter(section, variant, (name + "_slowdown").c_str(), k.slowdown);
+    }
+    return knees;
+}
+
+} // namespace bench
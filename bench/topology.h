@@ -0,0 +1,239 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Cache and core topology
+//
+// Block sizes, thread counts and "does it fit in cache" thresholds should come from the machine
+// the benchmark runs on, not from constants tuned on someone else's. bench::host() reads them
+// once, from sysfs (Linux) if it can, else from CPUID (x86), else falls back to typical values
+// so a benchmark still runs:
+//
+//   const bench::topology &t = bench::host();
+//   const std::size_t block = t.data_cache_size(2) / 2 / sizeof(int); // half of L2, in ints
+//   scan_inclusive_parallel(in, out, n, t.physical_cores);
+//
+// The kernels themselves stay parameterised (block, threads, ...) as they are in the cheatsheets;
+// the benchmarks pick the values from here. Cache sizes are per instance: the L3 on a multi-CCX
+// part is the size of one CCX's L3, shared by shared_by logical CPUs, not the total on the chip.
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <fstream>
+#include <set>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <cpuid.h>
+#endif
+
+namespace bench {
+
+struct cache_level {
+    enum class kind { data, instruction, unified };
+
+    int level = 0;
+    kind type = kind::unified;
+    std::size_t size = 0; // bytes
+    std::size_t line_size = 0;
+    std::size_t ways = 0;
+    unsigned shared_by = 1; // logical CPUs sharing one instance
+};
+
+struct topology {
+    std::vector<cache_level> caches; // ordered by level, data before instruction
+    unsigned logical_cpus = 1;
+    unsigned physical_cores = 1;
+    unsigned packages = 1;
+    std::size_t line_size = 64;
+    const char *source = "defaults"; // "sysfs", "cpuid" or "defaults"
+
+    // The data (or unified) cache at level, or nullptr if there isn't one.
+    const cache_level *data_cache(int level) const {
+        for (const cache_level &c : caches) {
+            if (c.level == level && c.type != cache_level::kind::instruction) {
+                return &c;
+            }
+        }
+        return nullptr;
+    }
+
+    // Size of the data cache at level, or of the nearest level below it if the machine has no such
+    // level (e.g. no L3), so callers don't have to check.
+    std::size_t data_cache_size(int level) const {
+        for (int l = level; l > 0; --l) {
+            if (const cache_level *c = data_cache(l)) {
+                return c->size;
+            }
+        }
+        return 32 * 1024;
+    }
+
+    // The largest data cache: the working set at which a kernel starts running from DRAM.
+    std::size_t last_level_size() const {
+        std::size_t size = 0;
+        for (const cache_level &c : caches) {
+            if (c.type != cache_level::kind::instruction) {
+                size = std::max(size, c.size);
+            }
+        }
+        return size ? size : data_cache_size(1);
+    }
+};
+
+namespace detail {
+
+inline std::string read_line(const std::string &path) {
+    std::ifstream f(path);
+    std::string line;
+    std::getline(f, line);
+    return line;
+}
+
+// "48K", "1024K", "32M"
+inline std::size_t parse_size(const std::string &s) {
+    std::size_t value = 0;
+    std::size_t i = 0;
+    for (; i < s.size() && s[i] >= '0' && s[i] <= '9'; ++i) {
+        value = value * 10 + static_cast<std::size_t>(s[i] - '0');
+    }
+    if (i < s.size()) {
+        if (s[i] == 'K') {
+            value <<= 10;
+        } else if (s[i] == 'M') {
+            value <<= 20;
+        } else if (s[i] == 'G') {
+            value <<= 30;
+        }
+    }
+    return value;
+}
+
+// "0-3,8-11" -> the CPU numbers in it
+inline std::vector<unsigned> parse_cpu_list(const std::string &s) {
+    std::vector<unsigned> cpus;
+    std::stringstream ss(s);
+    std::string range;
+    while (std::getline(ss, range, ',')) {
+        if (range.empty()) {
+            continue;
+        }
+        const auto dash = range.find('-');
+        const unsigned first = static_cast<unsigned>(std::stoul(range.substr(0, dash)));
+        const unsigned last =
+            dash == std::string::npos ? first : static_cast<unsigned>(std::stoul(range.substr(dash + 1)));
+        for (unsigned cpu = first; cpu <= last; ++cpu) {
+            cpus.push_back(cpu);
+        }
+    }
+    return cpus;
+}
+
+inline bool read_sysfs(topology &t) {
+    const std::string cpu = "/sys/devices/system/cpu/";
+    for (int index = 0;; ++index) {
+        const std::string dir = cpu + "cpu0/cache/index" + std::to_string(index) + "/";
+        const std::string level = read_line(dir + "level");
+        if (level.empty()) {
+            break;
+        }
+        cache_level c;
+        c.level = std::stoi(level);
+        const std::string type = read_line(dir + "type");
+        c.type = type == "Data"          ? cache_level::kind::data
+                 : type == "Instruction" ? cache_level::kind::instruction
+                                         : cache_level::kind::unified;
+        c.size = parse_size(read_line(dir + "size"));
+        c.line_size = parse_size(read_line(dir + "coherency_line_size"));
+        c.ways = parse_size(read_line(dir + "ways_of_associativity"));
+        const auto sharing = parse_cpu_list(read_line(dir + "shared_cpu_list"));
+        c.shared_by = std::max<unsigned>(1, static_cast<unsigned>(sharing.size()));
+        if (c.size) {
+            t.caches.push_back(c);
+        }
+    }
+    if (t.caches.empty()) {
+        return false;
+    }
+
+    const std::vector<unsigned> online = parse_cpu_list(read_line(cpu + "online"));
+    std::set<std::pair<std::string, std::string>> cores;
+    std::set<std::string> packages;
+    for (unsigned n : online) {
+        const std::string dir = cpu + "cpu" + std::to_string(n) + "/topology/";
+        const std::string package = read_line(dir + "physical_package_id");
+        cores.emplace(package, read_line(dir + "core_id"));
+        packages.insert(package);
+    }
+    if (!online.empty()) {
+        t.logical_cpus = static_cast<unsigned>(online.size());
+        t.physical_cores = static_cast<unsigned>(cores.size());
+        t.packages = static_cast<unsigned>(packages.size());
+    }
+    t.source = "sysfs";
+    return true;
+}
+
+// CPUID's deterministic cache parameters: leaf 4 on Intel, 0x8000001D on AMD.
+inline bool read_cpuid(topology &t) {
+#if defined(__x86_64__) || defined(__i386__)
+    for (const unsigned leaf : {4u, 0x8000001Du}) {
+        unsigned a, b, c, d;
+        if (__get_cpuid_max(leaf & 0x80000000u, nullptr) < leaf) {
+            continue;
+        }
+        for (unsigned sub = 0; __get_cpuid_count(leaf, sub, &a, &b, &c, &d) && (a & 31) != 0; ++sub) {
+            cache_level level;
+            level.level = static_cast<int>((a >> 5) & 7);
+            level.type = (a & 31) == 1   ? cache_level::kind::data
+                         : (a & 31) == 2 ? cache_level::kind::instruction
+                                         : cache_level::kind::unified;
+            level.line_size = (b & 4095) + 1;
+            level.ways = (b >> 22) + 1;
+            level.size = level.ways * (((b >> 12) & 1023) + 1) * level.line_size * (c + 1);
+            level.shared_by = ((a >> 14) & 4095) + 1;
+            t.caches.push_back(level);
+        }
+        if (!t.caches.empty()) {
+            t.logical_cpus = std::max(1u, std::thread::hardware_concurrency());
+            // CPUID doesn't say how many cores share a package without walking the x2APIC
+            // topology; L1 sharing is the number of SMT threads per core, which is enough here
+            t.physical_cores = std::max(1u, t.logical_cpus / std::max(1u, t.caches.front().shared_by));
+            t.source = "cpuid";
+            return true;
+        }
+    }
+#endif
+    (void)t;
+    return false;
+}
+
+} // namespace detail
+
+inline topology detect_topology() {
+    topology t;
+    if (!detail::read_sysfs(t) && !detail::read_cpuid(t)) {
+        using kind = cache_level::kind;
+        t.caches = {{1, kind::data, 32 * 1024, 64, 8, 1},
+                    {1, kind::instruction, 32 * 1024, 64, 8, 1},
+                    {2, kind::unified, 1024 * 1024, 64, 16, 1},
+                    {3, kind::unified, 8 * 1024 * 1024, 64, 16, 1}};
+        t.logical_cpus = t.physical_cores = std::max(1u, std::thread::hardware_concurrency());
+    }
+    if (const cache_level *l1 = t.data_cache(1)) {
+        t.line_size = l1->line_size ? l1->line_size : t.line_size;
+    }
+    return t;
+}
+
+// Detected once, on first use.
+inline const topology &host() {
+    static const topology t = detect_topology();
+    return t;
+}
+
+} // namespace bench
@@ -0,0 +1,92 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Benchmarks for unswitching.cpp
+//
+//   g++ -std=c++20 -O2 -march=native -o unswitching_bench bench/unswitching.cpp
+//
+// Built at -O2, where GCC doesn't unswitch on its own, so scale_1 and transform_1 keep the flag
+// tests in the loop. Kernels are called through bench::opaque so they're timed as compiled on
+// their own, not specialised for the constant flags in this file. Times are per element, for an
+// array in L1/L2 and one in L3.
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include "../unswitching.cpp"
+
+#include "bench.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+
+using scale_fn = void (*)(std::vector<int> &, int, YesNo);
+using transform_fn = void (*)(std::vector<int> &, int, YesNo, YesNo, YesNo);
+
+const char *name(YesNo flag) {
+    return flag == YesNo::Yes ? "Yes" : "No";
+}
+
+// factor -1 keeps repeated runs from overflowing
+constexpr int factor = -1;
+
+void scale(const std::vector<int> &data, const char *variant, scale_fn f, YesNo clamp) {
+    std::vector<int> expected = data, got = data;
+    scale_1(expected, factor, clamp);
+    f(got, factor, clamp);
+    if (got != expected) {
+        std::fprintf(stderr, "%s: wrong result\n", variant);
+        std::exit(1);
+    }
+    const std::string label = std::string(variant) + "/clamp=" + name(clamp);
+    bench::run("loop_unswitching", label.c_str(), data.size(), [&] {
+        bench::opaque(f)(got, factor, clamp);
+    });
+}
+
+void transform(const std::vector<int> &data, const char *variant, transform_fn f, YesNo scale,
+               YesNo clamp_low, YesNo clamp_high) {
+    std::vector<int> expected = data, got = data;
+    transform_1(expected, factor, scale, clamp_low, clamp_high);
+    f(got, factor, scale, clamp_low, clamp_high);
+    if (got != expected) {
+        std::fprintf(stderr, "%s: wrong result\n", variant);
+        std::exit(1);
+    }
+    const std::string label = std::string(variant) + "/" + name(scale) + name(clamp_low) + name(clamp_high);
+    bench::run("unswitching_several_flags", label.c_str(), data.size(), [&] {
+        bench::opaque(f)(got, factor, scale, clamp_low, clamp_high);
+    });
+}
+
+} // namespace
+
+int main() {
+    bench::header();
+    std::mt19937 rng(42);
+    std::uniform_int_distribution<int> dist(-2000, 2000);
+
+    for (std::size_t n : {4096, 1 << 22}) {
+        std::vector<int> data(n);
+        for (int &x : data) {
+            x = dist(rng);
+        }
+        for (YesNo clamp : {YesNo::Yes, YesNo::No}) {
+            scale(data, "scale_1", scale_1, clamp);
+            scale(data, "scale_2", scale_2, clamp);
+            scale(data, "scale_3", scale_3, clamp);
+        }
+        // every combination, so a kernel table entry or flag bit out of place shows up
+        for (YesNo s : {YesNo::Yes, YesNo::No}) {
+            for (YesNo low : {YesNo::Yes, YesNo::No}) {
+                for (YesNo high : {YesNo::Yes, YesNo::No}) {
+                    transform(data, "transform_1", transform_1, s, low, high);
+                    transform(data, "transform_2", transform_2, s, low, high);
+                    transform(data, "transform_3", transform_3, s, low, high);
+                }
+            }
+        }
+    }
+    return 0;
+}
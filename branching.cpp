@@ -93,6 +93,8 @@ bool branch_ex_2(YesNo yesno, int a) {
 // that for known sizes the compiler can optimise this away.
 ///////////////////////////////////////////////////////////////////////////////////////////////////
 
+#include <vector>
+
 void branch_while_1(std::vector<int> &in) {
     int i = 0;
     while (i < in.size()) {
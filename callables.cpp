@@ -0,0 +1,155 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Passing callables
+//
+// A generic loop that takes the per-element operation as an argument: the loop_unrolling kernel
+// from looping.cpp (a[i] = i) becomes a[i] = f(i). How f is passed decides whether the compiler
+// can see through it:
+//  - template parameter: the callable's type is part of the instantiation, so the call is
+//    inlined and the loop optimised as if written by hand. One copy of the loop per callable
+//  - function pointer: an indirect call per element, unless the loop is inlined into a caller
+//    that passes a known function (then GCC propagates it and inlines after all)
+//  - std::function: an indirect call through the type erased wrapper per element, and it may
+//    allocate when constructed from a lambda with large captures. GCC doesn't see through it
+//  - function_ref: a pointer to the callable and a pointer to a function that calls it. Cheap to
+//    pass and never allocates, but an indirect call per element with the same exception as a
+//    function pointer. std::function_ref is C++26, so a minimal one is below
+//
+// Each loop compiled on its own, with the callable passed in at run time (g++ 12 -march=znver4,
+// 4096 ints, bench/callables.cpp). GCC 12 vectorises nothing at -O2, so the gap there is only
+// the call; at -O3 the template version is also vectorised:
+//
+//                            inlined   vectorised (-O3)   ns per element -O2   -O3
+//   generate_1 template           yes                yes                 0.24   0.03
+//   generate_2 pointer             no                 no                 0.81   0.82
+//   generate_3 std::function       no                 no                 0.81   1.02
+//   generate_4 function_ref        no                 no                 0.80   0.80
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include <cstddef> //size_t
+#include <functional>
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+template <typename Signature>
+class function_ref;
+
+template <typename R, typename... Args>
+class function_ref<R(Args...)> {
+public:
+    template <typename F>
+        requires(!std::is_same_v<std::remove_cvref_t<F>, function_ref> &&
+                 std::is_invocable_r_v<R, F &, Args...>)
+    function_ref(F &&f) noexcept // NOLINT: implicit, like std::function
+        : object_(const_cast<void *>(static_cast<const void *>(std::addressof(f)))),
+          call_([](void *object, Args... args) -> R {
+              auto &callable = *static_cast<std::remove_reference_t<F> *>(object);
+              return std::invoke(callable, std::forward<Args>(args)...);
+          }) {}
+
+    R operator()(Args... args) const {
+        return call_(object_, std::forward<Args>(args)...);
+    }
+
+private:
+    void *object_;
+    R (*call_)(void *, Args...);
+};
+
+template <typename F>
+void generate_1(int *a, std::size_t n, F f) {
+    for (std::size_t i = 0; i < n; ++i) {
+        a[i] = f(static_cast<int>(i));
+    }
+}
+
+void generate_2(int *a, std::size_t n, int (*f)(int)) {
+    for (std::size_t i = 0; i < n; ++i) {
+        a[i] = f(static_cast<int>(i));
+    }
+}
+
+void generate_3(int *a, std::size_t n, const std::function<int(int)> &f) {
+    for (std::size_t i = 0; i < n; ++i) {
+        a[i] = f(static_cast<int>(i));
+    }
+}
+
+void generate_4(int *a, std::size_t n, function_ref<int(int)> f) {
+    for (std::size_t i = 0; i < n; ++i) {
+        a[i] = f(static_cast<int>(i));
+    }
+}
+
+struct times_3_plus_1 {
+    int operator()(int i) const {
+        return i * 3 + 1;
+    }
+};
+
+template void generate_1<times_3_plus_1>(int *, std::size_t, times_3_plus_1);
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Passing callables with two inputs
+//
+// The data_dependancy_2 loop from looping.cpp with the + passed in. It only vectorises when the
+// operation is visible, so the indirect call costs the vectorisation as well as the call:
+//
+//                            inlined   vectorised (-O3)   ns per element -O2   -O3
+//   combine_1 template            yes                yes                 0.28   0.07
+//   combine_2 pointer              no                 no                 1.60   1.62
+//   combine_3 std::function        no                 no                 1.62   1.61
+//   combine_4 function_ref         no                 no                 1.60   1.63
+//   combine_2_plus                yes                yes                 0.29   0.07
+//
+// A function pointer or function_ref passed to a loop that is then inlined into a caller where
+// it's a constant gets the inlining back: combine_2_plus compiles to the same loop as combine_1.
+// But that depends on the inliner's heuristics and on everything being in one TU (see
+// lto/kernel.h), and std::function doesn't get it back even then - GCC keeps the indirect call.
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include <cstddef> //size_t
+#include <functional>
+
+template <typename F>
+void combine_1(int *a, int *b, const int *c, std::size_t n, F op) {
+    for (std::size_t i = 0; i < n; ++i) {
+        b[i] = op(b[i], c[i]);
+        a[i] = op(a[i], b[i]);
+    }
+}
+
+void combine_2(int *a, int *b, const int *c, std::size_t n, int (*op)(int, int)) {
+    for (std::size_t i = 0; i < n; ++i) {
+        b[i] = op(b[i], c[i]);
+        a[i] = op(a[i], b[i]);
+    }
+}
+
+void combine_3(int *a, int *b, const int *c, std::size_t n, const std::function<int(int, int)> &op) {
+    for (std::size_t i = 0; i < n; ++i) {
+        b[i] = op(b[i], c[i]);
+        a[i] = op(a[i], b[i]);
+    }
+}
+
+void combine_4(int *a, int *b, const int *c, std::size_t n, function_ref<int(int, int)> op) {
+    for (std::size_t i = 0; i < n; ++i) {
+        b[i] = op(b[i], c[i]);
+        a[i] = op(a[i], b[i]);
+    }
+}
+
+inline int plus(int x, int y) {
+    return x + y;
+}
+
+template void combine_1<std::plus<>>(int *, int *, const int *, std::size_t, std::plus<>);
+
+void combine_2_plus(int *a, int *b, const int *c, std::size_t n) {
+    combine_2(a, b, c, n, plus);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,121 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Unroll factor
+//
+// Loop unrolling (looping.cpp) lists "increased binary" and "register usage" as the cons. Here
+// they are with numbers. crc_streams<U> hashes a buffer as U interleaved CRC32 streams. crc32
+// has a latency of 3 cycles and a throughput of 1 per cycle, so one stream waits on itself and
+// 3 or more keep the unit busy. Unrolling past that buys nothing and costs:
+//
+//   U                    1     2     4     8    16    32      (g++ 12 -O2 -march=znver4)
+//   bytes               35   109   189   335   798  1912
+//   instructions        10    25    42    81   184   408
+//   stack accesses       -     -     -     -     3     3
+//   gpr/xmm moves        -     -     -     -    37   141
+//
+// At U = 16 and 32 the streams don't fit in the 16 general purpose registers. On Zen 4 GCC
+// spills them into xmm registers (vmovq) rather than to the stack, which is cheaper, but still
+// extra instructions: at U = 16 four of the streams go through xmm, 9 vmovq in a 29 instruction
+// loop. tools/report.cpp prints this table for every function it shows, so it can be
+// regenerated for any compiler and flags (the instantiations below are there for it).
+//
+// The bytes matter once the kernel is one of many. bench/code_size.cpp times one kernel on a
+// 64KB buffer, then 128 copies of it called in turn on 512 bytes each (a hot set of 4KB at U = 1
+// up to 240KB at U = 32, against a 32KB L1i):
+//
+//   U                    1     2     4     8    16    32      ns per word
+//   one kernel        0.59  0.30  0.15  0.09  0.12  0.13
+//   128 copies        0.28  0.16  0.12  0.16  0.23  0.43
+//
+// On its own U = 8 is fastest; as one of many U = 4 is, and U = 32 is slower than not unrolling
+// at all. The L1 i-cache miss counter goes up about 25 times from U = 4 to U = 16 but then down
+// again at U = 32 - long straight line code is what the instruction prefetcher handles best - so
+// time the hot set as it really runs rather than going by the counter or the bytes alone.
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include <cstddef> //size_t
+#include <cstdint>
+#include <immintrin.h>
+
+#if defined(__SSE4_2__)
+template <int U>
+std::uint64_t crc_streams(const std::uint64_t *data, std::size_t n) {
+    std::uint64_t crc[U];
+#pragma GCC unroll 64
+    for (int u = 0; u < U; ++u) {
+        crc[u] = u;
+    }
+    const std::size_t full = n - n % U;
+    std::size_t i = 0;
+    for (; i < full; i += U) {
+#pragma GCC unroll 64
+        for (int u = 0; u < U; ++u) {
+            crc[u] = _mm_crc32_u64(crc[u], data[i + u]);
+        }
+    }
+    for (; i < n; ++i) {
+        crc[0] = _mm_crc32_u64(crc[0], data[i]);
+    }
+    std::uint64_t hash = 0;
+#pragma GCC unroll 64
+    for (int u = 0; u < U; ++u) {
+        hash = hash * 31 + crc[u];
+    }
+    return hash;
+}
+
+template std::uint64_t crc_streams<1>(const std::uint64_t *, std::size_t);
+template std::uint64_t crc_streams<2>(const std::uint64_t *, std::size_t);
+template std::uint64_t crc_streams<4>(const std::uint64_t *, std::size_t);
+template std::uint64_t crc_streams<8>(const std::uint64_t *, std::size_t);
+template std::uint64_t crc_streams<16>(const std::uint64_t *, std::size_t);
+template std::uint64_t crc_streams<32>(const std::uint64_t *, std::size_t);
+#endif
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Specialising for size
+//
+// A size known at compile time lets the compiler drop the loop tests and the tail loop, and
+// unroll completely when the result is small enough (--param max-completely-peeled-insns). Like
+// branch_removal<N> in branching.cpp, every N is a separate copy of the code, so the code grows
+// with the number of sizes used as well as with N:
+//
+//   N                 8    16    32    64   256    runtime n (crc_streams<4>)
+//   bytes -O2       113   108   108   108   108    189         (g++ 12 -march=znver4)
+//   bytes -O3       113   168   328   651   108    189
+//
+// At -O2 only N = 8 is unrolled completely (straight line code, no branches); the rest keep the
+// loop and save the tail loop and the size tests. -O3 unrolls up to 64, so the copies grow with
+// N until it gives up. The gain is biggest for the smallest N, where the loop overhead is most of
+// the work: at N = 8 crc_fixed<8> takes 0.18ns per word against 0.22 for crc_streams<4>, at
+// N = 64 they're within 3%. Specialise the handful of sizes that are hot and let everything else
+// take the generic path. [[gnu::flatten]] makes sure crc_streams is inlined into each copy,
+// otherwise crc_fixed<N> is just a call with n = N.
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include <cstddef> //size_t
+#include <cstdint>
+
+#if defined(__SSE4_2__)
+template <std::size_t N>
+[[gnu::flatten]] std::uint64_t crc_fixed(const std::uint64_t *data) {
+    return crc_streams<4>(data, N);
+}
+
+std::uint64_t crc_dispatch(const std::uint64_t *data, std::size_t n) {
+    switch (n) {
+        case 8: return crc_fixed<8>(data);
+        case 16: return crc_fixed<16>(data);
+        default: return crc_streams<4>(data, n);
+    }
+}
+
+template std::uint64_t crc_fixed<8>(const std::uint64_t *);
+template std::uint64_t crc_fixed<16>(const std::uint64_t *);
+template std::uint64_t crc_fixed<32>(const std::uint64_t *);
+template std::uint64_t crc_fixed<64>(const std::uint64_t *);
+template std::uint64_t crc_fixed<256>(const std::uint64_t *);
+#endif
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,196 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Small buffer optimisation - small_vector<T, N>
+//
+// branch_while_1/2 (branching.cpp) take a std::vector<int>&. A std::vector always puts its
+// elements on the heap, so even a vector of 3 ints costs a malloc and a free, and the elements
+// are one pointer chase away from wherever the vector itself lives.
+//
+// small_vector keeps the first N elements inside the object. As long as the size stays at or
+// below N there is no allocation at all, and the elements sit next to the size/capacity fields
+// (usually on the stack). Past N it moves everything to the heap and behaves like std::vector.
+//
+// Costs:
+//  - sizeof(small_vector<T, N>) is N * sizeof(T) bigger, so don't pick a large N or nest them
+//  - moving one that is still inline has to move the elements, not just steal a pointer
+//  - begin() is the same pointer either way, so iteration costs nothing extra
+//
+// Trivial relocation: for trivially copyable T (ints, PODs) growing and moving are a memcpy.
+// For other types each element is move constructed into place and the old one destroyed.
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include <cstddef> //size_t
+#include <cstring>
+#include <initializer_list>
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+template <typename T, std::size_t N>
+class small_vector {
+    static_assert(N > 0, "use std::vector if there's no inline storage");
+
+public:
+    using value_type = T;
+    using size_type = std::size_t;
+    using iterator = T *;
+    using const_iterator = const T *;
+
+    small_vector() = default;
+
+    small_vector(std::initializer_list<T> init) {
+        reserve(init.size());
+        std::uninitialized_copy(init.begin(), init.end(), data_);
+        size_ = init.size();
+    }
+
+    small_vector(const small_vector &other) {
+        reserve(other.size_);
+        std::uninitialized_copy(other.begin(), other.end(), data_);
+        size_ = other.size_;
+    }
+
+    small_vector(small_vector &&other) noexcept(std::is_nothrow_move_constructible_v<T>) {
+        take(std::move(other));
+    }
+
+    small_vector &operator=(const small_vector &other) {
+        if (this != &other) {
+            clear();
+            reserve(other.size_);
+            std::uninitialized_copy(other.begin(), other.end(), data_);
+            size_ = other.size_;
+        }
+        return *this;
+    }
+
+    small_vector &operator=(small_vector &&other) noexcept(std::is_nothrow_move_constructible_v<T>) {
+        if (this != &other) {
+            clear();
+            release();
+            take(std::move(other));
+        }
+        return *this;
+    }
+
+    ~small_vector() {
+        clear();
+        release();
+    }
+
+    iterator begin() { return data_; }
+    iterator end() { return data_ + size_; }
+    const_iterator begin() const { return data_; }
+    const_iterator end() const { return data_ + size_; }
+
+    T *data() { return data_; }
+    const T *data() const { return data_; }
+    size_type size() const { return size_; }
+    size_type capacity() const { return capacity_; }
+    bool empty() const { return size_ == 0; }
+    bool is_inline() const { return data_ == inline_data(); }
+
+    T &operator[](size_type i) { return data_[i]; }
+    const T &operator[](size_type i) const { return data_[i]; }
+    T &front() { return data_[0]; }
+    T &back() { return data_[size_ - 1]; }
+
+    void push_back(const T &value) { emplace_back(value); }
+    void push_back(T &&value) { emplace_back(std::move(value)); }
+
+    template <typename... Args>
+    T &emplace_back(Args &&...args) {
+        if (size_ == capacity_) [[unlikely]] {
+            // construct first: args may refer to an element that's about to be relocated
+            T value(std::forward<Args>(args)...);
+            grow(capacity_ * 2);
+            return *::new (data_ + size_++) T(std::move(value));
+        }
+        return *::new (data_ + size_++) T(std::forward<Args>(args)...);
+    }
+
+    void pop_back() {
+        data_[--size_].~T();
+    }
+
+    void clear() {
+        std::destroy(begin(), end());
+        size_ = 0;
+    }
+
+    void reserve(size_type n) {
+        if (n > capacity_) {
+            grow(n);
+        }
+    }
+
+    void resize(size_type n) {
+        reserve(n);
+        if (n > size_) {
+            std::uninitialized_value_construct(data_ + size_, data_ + n);
+        } else {
+            std::destroy(data_ + n, data_ + size_);
+        }
+        size_ = n;
+    }
+
+private:
+    // The address of the inline storage, not of an element: it's taken when the buffer is empty,
+    // so it can't go through std::launder, which needs an object to be alive there.
+    T *inline_data() { return reinterpret_cast<T *>(buffer_); }
+    const T *inline_data() const { return reinterpret_cast<const T *>(buffer_); }
+
+    // move n elements from src to uninitialised dst and end the lifetime of the originals
+    static void relocate(T *src, size_type n, T *dst) {
+        if constexpr (std::is_trivially_copyable_v<T>) {
+            if (n != 0) {
+                std::memcpy(static_cast<void *>(dst), src, n * sizeof(T));
+            }
+        } else {
+            std::uninitialized_move(src, src + n, dst);
+            std::destroy(src, src + n);
+        }
+    }
+
+    void grow(size_type n) {
+        T *heap = std::allocator<T>().allocate(n);
+        relocate(data_, size_, heap);
+        release();
+        data_ = heap;
+        capacity_ = n;
+    }
+
+    // free the heap block (elements must already be destroyed or relocated)
+    void release() {
+        if (!is_inline()) {
+            std::allocator<T>().deallocate(data_, capacity_);
+            data_ = inline_data();
+            capacity_ = N;
+        }
+    }
+
+    void take(small_vector &&other) {
+        if (other.is_inline()) {
+            relocate(other.data_, other.size_, data_);
+        } else {
+            data_ = std::exchange(other.data_, other.inline_data());
+            capacity_ = std::exchange(other.capacity_, N);
+        }
+        size_ = std::exchange(other.size_, 0);
+    }
+
+    alignas(T) unsigned char buffer_[N * sizeof(T)];
+    T *data_ = inline_data();
+    size_type size_ = 0;
+    size_type capacity_ = N;
+};
+
+// the loop from branch_while_2 in branching.cpp, over a small_vector
+void branch_while_3(small_vector<int, 16> &in) {
+    std::size_t i = 0;
+    do {
+        in[i] += 1;
+        i++;
+    } while (i < in.size());
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,204 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Enum underlying type
+//
+// An enum class is an int unless told otherwise, so the YesNo in branching.cpp costs 4 bytes to
+// hold 1 bit of information. Giving it a uint8_t underlying type is a one word change that cuts
+// the memory (and the bandwidth of every loop over it) by 4, and lets the compiler process 4x
+// as many flags per vector register.
+//
+// GCC only vectorises these loops at -O3 (or -O2 -fvect-cost-model=dynamic); at -O2 it uses a
+// "very cheap" cost model that skips any loop needing a scalar epilogue, and both run 1 per cycle.
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include <cstddef> //size_t
+#include <cstdint>
+#include <vector>
+
+enum class YesNo {
+    Yes,
+    No
+};
+
+enum class YesNo8 : std::uint8_t {
+    Yes,
+    No
+};
+
+static_assert(sizeof(YesNo) == 4);
+static_assert(sizeof(YesNo8) == 1);
+
+std::size_t count_yes_1(const std::vector<YesNo> &flags) {
+    std::uint32_t count = 0; // a 64-bit count would make every lane widen to 64 bits
+    for (YesNo f : flags) {
+        count += f == YesNo::Yes;
+    }
+    return count;
+}
+
+std::size_t count_yes_2(const std::vector<YesNo8> &flags) {
+    std::uint32_t count = 0; // a 64-bit count would make every lane widen to 64 bits
+    for (YesNo8 f : flags) {
+        count += f == YesNo8::Yes;
+    }
+    return count;
+}
+
+// Yes where both are Yes. & rather than && so there is no short-circuit branch in the way of
+// vectorisation.
+void and_yes_1(std::vector<YesNo> &a, const std::vector<YesNo> &b) {
+    for (std::size_t i = 0; i < a.size(); ++i) {
+        a[i] = ((a[i] == YesNo::Yes) & (b[i] == YesNo::Yes)) ? YesNo::Yes : YesNo::No;
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Bit packed flags
+//
+// Going further, store one flag per bit in 64-bit words: a million flags is 125KB instead of 4MB
+// and fits in L2. Counting is then one popcnt per 64 flags, and combining two sets of flags
+// (and, or, and-not) is one instruction per 64 flags, which the compiler vectorises on its own at
+// -O3.
+//
+// std::vector<bool> is also bit packed, but only gives element-at-a-time access through a proxy
+// reference; there is no way to and two of them or count the set bits a word at a time.
+//
+// Bits past size() in the last word are kept zero, so count and the bulk operations never need
+// to mask them off.
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include <bit>
+#include <cstddef> //size_t
+#include <cstdint>
+#include <vector>
+
+class yes_no_bits {
+public:
+    explicit yes_no_bits(std::size_t size = 0) : words_((size + 63) / 64, 0), size_(size) {}
+
+    std::size_t size() const { return size_; }
+    std::size_t memory() const { return words_.size() * sizeof(std::uint64_t); }
+
+    YesNo get(std::size_t i) const {
+        return (words_[i / 64] >> (i % 64)) & 1 ? YesNo::Yes : YesNo::No;
+    }
+
+    void set(std::size_t i, YesNo value) {
+        const std::uint64_t bit = std::uint64_t(1) << (i % 64);
+        // branchless: clear the bit, then or in 0 or the bit
+        words_[i / 64] = (words_[i / 64] & ~bit) | (bit & -std::uint64_t(value == YesNo::Yes));
+    }
+
+    std::size_t count_yes() const {
+        std::size_t count = 0;
+        for (std::uint64_t w : words_) {
+            count += std::popcount(w);
+        }
+        return count;
+    }
+
+    // this = this & other: Yes where both are Yes
+    yes_no_bits &operator&=(const yes_no_bits &other) {
+        for (std::size_t w = 0; w < words_.size(); ++w) {
+            words_[w] &= other.words_[w];
+        }
+        return *this;
+    }
+
+    // this = this | other: Yes where either is Yes
+    yes_no_bits &operator|=(const yes_no_bits &other) {
+        for (std::size_t w = 0; w < words_.size(); ++w) {
+            words_[w] |= other.words_[w];
+        }
+        return *this;
+    }
+
+    // this = this & ~other: Yes where this is Yes and other is No
+    yes_no_bits &and_not(const yes_no_bits &other) {
+        for (std::size_t w = 0; w < words_.size(); ++w) {
+            words_[w] &= ~other.words_[w];
+        }
+        return *this;
+    }
+
+    const std::uint64_t *words() const { return words_.data(); }
+    std::size_t word_count() const { return words_.size(); }
+
+private:
+    std::vector<std::uint64_t> words_;
+    std::size_t size_;
+};
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// SIMD popcount - https://arxiv.org/abs/1611.07612
+//
+// The and/or/and-not loops above vectorise without help at -O3. Counting is the one that doesn't:
+// with only -mpopcnt the compiler emits one popcnt per word, which retires at 1 word per cycle.
+//
+//  - AVX2 has no vector popcount, but pshufb can look up the count of each 4-bit nibble in a
+//    16 entry table, 32 bytes at a time. psadbw then sums the byte counts into 64-bit lanes.
+//  - AVX-512 VPOPCNTDQ (Ice Lake, Zen 4) has vpopcntq: 8 words per instruction.
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include <bit>
+#include <cstddef> //size_t
+#include <cstdint>
+#include <immintrin.h>
+
+std::size_t popcount_words_1(const std::uint64_t *words, std::size_t n) {
+    std::size_t count = 0;
+    for (std::size_t i = 0; i < n; ++i) {
+        count += std::popcount(words[i]);
+    }
+    return count;
+}
+
+#if defined(__AVX2__)
+std::size_t popcount_words_avx2(const std::uint64_t *words, std::size_t n) {
+    const __m256i table = _mm256_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4,
+                                           0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+    const __m256i low_nibble = _mm256_set1_epi8(0x0f);
+    __m256i total = _mm256_setzero_si256();
+    std::size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(words + i));
+        const __m256i lo = _mm256_shuffle_epi8(table, _mm256_and_si256(v, low_nibble));
+        const __m256i hi = _mm256_shuffle_epi8(table, _mm256_and_si256(_mm256_srli_epi16(v, 4), low_nibble));
+        // per byte counts (max 8) summed into four 64-bit lanes
+        total = _mm256_add_epi64(total, _mm256_sad_epu8(_mm256_add_epi8(lo, hi), _mm256_setzero_si256()));
+    }
+    std::size_t count = _mm256_extract_epi64(total, 0) + _mm256_extract_epi64(total, 1) +
+                        _mm256_extract_epi64(total, 2) + _mm256_extract_epi64(total, 3);
+    for (; i < n; ++i) {
+        count += std::popcount(words[i]);
+    }
+    return count;
+}
+#endif
+
+#if defined(__AVX512VPOPCNTDQ__)
+std::size_t popcount_words_avx512(const std::uint64_t *words, std::size_t n) {
+    __m512i total = _mm512_setzero_si512();
+    std::size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        total = _mm512_add_epi64(total, _mm512_popcnt_epi64(_mm512_loadu_si512(words + i)));
+    }
+    // summed through GCC's vector extensions: _mm512_reduce_add_epi64 trips GCC 12's
+    // -Wuninitialized
+    using uint64x8 = std::uint64_t __attribute__((vector_size(64)));
+    const auto lanes = reinterpret_cast<uint64x8>(total);
+    std::size_t count = 0;
+    for (int lane = 0; lane < 8; ++lane) {
+        count += lanes[lane];
+    }
+    for (; i < n; ++i) {
+        count += std::popcount(words[i]);
+    }
+    return count;
+}
+#endif
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
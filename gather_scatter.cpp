@@ -0,0 +1,168 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Indirect access (gather/scatter) - https://en.wikipedia.org/wiki/Gather/scatter_(vector_addressing)
+//
+// Real loops rarely index a[i]; they index through another array. Reading a[idx[i]] is a gather,
+// writing a[idx[i]] is a scatter. Two things make these slower than the direct loops in
+// looping.cpp:
+//  - every access can touch a different cache line, so when a[] is larger than the cache the
+//    loop is bound by memory latency rather than by the arithmetic
+//  - for a scatter the compiler can't prove two iterations don't hit the same element
+//    (idx[i] == idx[j]), so a[idx[i]] += b[i] is never vectorised
+//
+// The gather can be vectorised (vpgatherdd, AVX2 and up). It still issues one load per lane, so
+// it saves instructions rather than memory traffic: when a[] is in DRAM it's no faster than the
+// scalar loop. Gather and scatter are microcoded on some CPUs (AMD Zen 4 for one), and there the
+// vector versions are slower than scalar even when the data is sorted and cached. Measure.
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include <cstddef> //size_t
+#include <immintrin.h>
+
+void gather_add_1(const int *a, const int *idx, const int *b, int *c, std::size_t n) {
+    for (std::size_t i = 0; i < n; ++i) {
+        c[i] = a[idx[i]] + b[i];
+    }
+}
+
+void scatter_add_1(int *a, const int *idx, const int *b, std::size_t n) {
+    for (std::size_t i = 0; i < n; ++i) {
+        a[idx[i]] += b[i];
+    }
+}
+
+#if defined(__AVX2__)
+void gather_add_avx2(const int *a, const int *idx, const int *b, int *c, std::size_t n) {
+    std::size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        const __m256i vi = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(idx + i));
+        const __m256i g = _mm256_i32gather_epi32(a, vi, 4);
+        const __m256i vb = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(b + i));
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(c + i), _mm256_add_epi32(g, vb));
+    }
+    for (; i < n; ++i) {
+        c[i] = a[idx[i]] + b[i];
+    }
+}
+#endif
+
+#if defined(__AVX512F__) && defined(__AVX512CD__)
+void gather_add_avx512(const int *a, const int *idx, const int *b, int *c, std::size_t n) {
+    std::size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        const __m512i vi = _mm512_loadu_si512(idx + i);
+        // the masked form with a zero source: the plain one leaves it undefined, which trips
+        // GCC 12's -Wmaybe-uninitialized
+        const __m512i g = _mm512_mask_i32gather_epi32(_mm512_setzero_si512(), 0xFFFF, vi, a, 4);
+        _mm512_storeu_si512(c + i, _mm512_add_epi32(g, _mm512_loadu_si512(b + i)));
+    }
+    for (; i < n; ++i) {
+        c[i] = a[idx[i]] + b[i];
+    }
+}
+
+// AVX-512 has a scatter, and vpconflictd tells us whether any two lanes share an index. If none
+// do, gather/add/scatter is safe. If some do, the scatter would keep only the last lane's sum, so
+// fall back to scalar for that vector. Random indices into a large a[] almost never conflict.
+void scatter_add_avx512(int *a, const int *idx, const int *b, std::size_t n) {
+    std::size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        const __m512i vi = _mm512_loadu_si512(idx + i);
+        const __m512i conflicts = _mm512_conflict_epi32(vi);
+        if (_mm512_test_epi32_mask(conflicts, conflicts) == 0) {
+            const __m512i g = _mm512_mask_i32gather_epi32(_mm512_setzero_si512(), 0xFFFF, vi, a, 4);
+            _mm512_i32scatter_epi32(a, vi, _mm512_add_epi32(g, _mm512_loadu_si512(b + i)), 4);
+        } else {
+            for (std::size_t j = i; j < i + 16; ++j) {
+                a[idx[j]] += b[j];
+            }
+        }
+    }
+    for (; i < n; ++i) {
+        a[idx[i]] += b[i];
+    }
+}
+#endif
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Prefetching indirect access
+//
+// The hardware prefetcher follows strides, it can't follow idx[]. But idx[] itself is read
+// sequentially, so we can look ahead and ask for a[idx[i + distance]] while working on
+// a[idx[i]]. The distance needs to cover memory latency: too short and the line hasn't arrived,
+// too long and it's evicted again before use. 16-64 elements is a sensible starting range.
+//
+// This only helps when a[] doesn't fit in cache. If it does, the prefetches are extra
+// instructions for nothing. With sorted indices the hardware prefetcher already copes and there
+// is nothing to gain; clustered indices still jump between clusters and do benefit.
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include <cstddef> //size_t
+
+void scatter_add_prefetch(int *a, const int *idx, const int *b, std::size_t n) {
+    constexpr std::size_t distance = 32;
+    std::size_t i = 0;
+    for (; i + distance < n; ++i) {
+        __builtin_prefetch(&a[idx[i + distance]], 1); // 1 = prefetch for write
+        a[idx[i]] += b[i];
+    }
+    for (; i < n; ++i) {
+        a[idx[i]] += b[i];
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Reordering indices for locality
+//
+// Addition doesn't care about order, so we're free to reorder the (idx[i], b[i]) pairs before
+// scattering. Grouping them by which block of a[] they touch means each block is brought into
+// cache once and all of its updates land while it's there.
+//
+//  - sort_by_index sorts the pairs outright: best locality, but O(n log n) up front
+//  - bucket_by_block is a single counting sort pass on idx / block: O(n), and good enough as
+//    long as one block of a[] fits in L2
+//
+// Either pre-pass costs more than one scatter, so it pays off when the same index array is used
+// many times (a mesh, a sparse matrix, a fixed permutation) or when a[] is far bigger than LLC.
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include <algorithm>
+#include <cstddef> //size_t
+#include <utility>
+#include <vector>
+
+void sort_by_index(const int *idx, const int *b, int *idx_out, int *b_out, std::size_t n) {
+    std::vector<std::pair<int, int>> pairs(n);
+    for (std::size_t i = 0; i < n; ++i) {
+        pairs[i] = {idx[i], b[i]};
+    }
+    std::sort(pairs.begin(), pairs.end(), [](const auto &l, const auto &r) { return l.first < r.first; });
+    for (std::size_t i = 0; i < n; ++i) {
+        idx_out[i] = pairs[i].first;
+        b_out[i] = pairs[i].second;
+    }
+}
+
+// block is a number of elements of a[], e.g. 64K ints = 256KB to fit in L2 (bench/topology.h
+// reads the L2 size)
+void bucket_by_block(const int *idx, const int *b, int *idx_out, int *b_out, std::size_t n,
+                     std::size_t a_size, std::size_t block) {
+    const std::size_t buckets = (a_size + block - 1) / block;
+    std::vector<std::size_t> start(buckets + 1, 0);
+    for (std::size_t i = 0; i < n; ++i) {
+        ++start[idx[i] / block + 1];
+    }
+    for (std::size_t k = 0; k < buckets; ++k) {
+        start[k + 1] += start[k];
+    }
+    for (std::size_t i = 0; i < n; ++i) {
+        const std::size_t pos = start[idx[i] / block]++;
+        idx_out[pos] = idx[i];
+        b_out[pos] = b[i];
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
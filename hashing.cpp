@@ -0,0 +1,251 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Linear probing hash table - https://en.wikipedia.org/wiki/Linear_probing
+//
+// std::unordered_map is a table of linked lists: every element is its own heap node, so a lookup
+// is a bucket load followed by at least one dependent pointer chase, usually a cache miss each.
+// Open addressing keeps keys and values in one flat array. On a collision we step to the next
+// slot, which is normally on the same cache line, so most lookups cost one miss.
+//
+// The price is a branch per probed slot (key equal? slot empty?) and a load factor that must
+// stay low - at 1/2 the expected probe length is ~1.5 for hits and ~2.5 for misses, but it grows
+// quickly beyond ~0.7 as clusters of full slots join up.
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include <cstddef> //size_t
+#include <cstdint>
+#include <vector>
+
+// std::hash<std::uint64_t> is the identity, which is fine for chaining but terrible for probing
+// with a power-of-two table (sequential keys all cluster). Mix the bits first.
+inline std::uint64_t hash_mix(std::uint64_t key) {
+    key ^= key >> 33;
+    key *= 0xff51afd7ed558ccdULL;
+    key ^= key >> 33;
+    key *= 0xc4ceb9fe1a85ec53ULL;
+    key ^= key >> 33;
+    return key;
+}
+
+class linear_map {
+public:
+    static constexpr std::uint64_t empty_key = ~std::uint64_t(0); // can't be used as a key
+
+    explicit linear_map(std::size_t capacity = 16) : slots_(round_up(capacity * 2)) {}
+
+    const std::uint64_t *find(std::uint64_t key) const {
+        const std::size_t mask = slots_.size() - 1;
+        for (std::size_t i = hash_mix(key) & mask;; i = (i + 1) & mask) {
+            if (slots_[i].key == key) {
+                return &slots_[i].value;
+            }
+            if (slots_[i].key == empty_key) {
+                return nullptr;
+            }
+        }
+    }
+
+    void insert(std::uint64_t key, std::uint64_t value) {
+        if ((size_ + 1) * 2 > slots_.size()) {
+            grow();
+        }
+        const std::size_t mask = slots_.size() - 1;
+        std::size_t i = hash_mix(key) & mask;
+        while (slots_[i].key != empty_key && slots_[i].key != key) {
+            i = (i + 1) & mask;
+        }
+        size_ += slots_[i].key == empty_key;
+        slots_[i] = {key, value};
+    }
+
+    std::size_t size() const { return size_; }
+    std::size_t memory() const { return slots_.size() * sizeof(slot); }
+
+private:
+    struct slot {
+        std::uint64_t key = empty_key;
+        std::uint64_t value = 0;
+    };
+
+    static std::size_t round_up(std::size_t n) {
+        std::size_t p = 16;
+        while (p < n) {
+            p *= 2;
+        }
+        return p;
+    }
+
+    void grow() {
+        std::vector<slot> old(slots_.size() * 2);
+        old.swap(slots_);
+        size_ = 0;
+        for (const slot &s : old) {
+            if (s.key != empty_key) {
+                insert(s.key, s.value);
+            }
+        }
+    }
+
+    std::vector<slot> slots_;
+    std::size_t size_ = 0;
+};
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// SIMD probed hash table (Swiss table) - https://abseil.io/about/design/swisstables
+//
+// Split the hash in two: h1 (the high bits) picks a group of 16 slots, h2 (the low 7 bits) is
+// stored in a separate control byte per slot. Empty slots have control byte 0x80. A lookup
+// loads the 16 control bytes of a group into one register and compares them all with h2 at once:
+//
+//   ctrl       [ 17, 80, 5a, 17, 80, ... ]       _mm_cmpeq_epi8(ctrl, set1(h2 = 17))
+//   match      [ ff, 00, 00, ff, 00, ... ]  ->   _mm_movemask_epi8  ->  0b...01001
+//
+// Only slots whose 7-bit tag matches have their key compared (a false positive is 1 in 128), and
+// a single "any empty in this group?" test ends a miss. That replaces up to 16 unpredictable
+// branches with one mostly predictable one, and the table can run at 7/8 load instead of 1/2,
+// roughly halving the memory of linear_map (and of std::unordered_map for small keys).
+//
+// Once the table is bigger than the cache, a hit costs two misses (the control group, then the
+// slot), so a half empty linear_map can still win on hits. Misses only touch the control bytes
+// and are where the Swiss table wins clearly. group32 does the same with AVX2 over 32 control
+// bytes; at 7/8 load almost every lookup already ends in its first group of 16, so the wider
+// compare rarely pays for itself.
+//
+// Not shown: deletion. Swiss tables mark deleted slots with a tombstone control byte so probing
+// doesn't stop early; match_empty would then have to distinguish empty from deleted.
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include <cstddef> //size_t
+#include <cstdint>
+#include <immintrin.h>
+#include <vector>
+
+struct group16 {
+    static constexpr std::size_t width = 16;
+
+    explicit group16(const std::int8_t *ctrl)
+        : ctrl_(_mm_loadu_si128(reinterpret_cast<const __m128i *>(ctrl))) {}
+
+    std::uint32_t match(std::int8_t h2) const {
+        return _mm_movemask_epi8(_mm_cmpeq_epi8(ctrl_, _mm_set1_epi8(h2)));
+    }
+
+    // only the empty byte (0x80) has its top bit set, so movemask finds them directly
+    std::uint32_t match_empty() const { return _mm_movemask_epi8(ctrl_); }
+
+    __m128i ctrl_;
+};
+
+#if defined(__AVX2__)
+struct group32 {
+    static constexpr std::size_t width = 32;
+
+    explicit group32(const std::int8_t *ctrl)
+        : ctrl_(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(ctrl))) {}
+
+    std::uint32_t match(std::int8_t h2) const {
+        return _mm256_movemask_epi8(_mm256_cmpeq_epi8(ctrl_, _mm256_set1_epi8(h2)));
+    }
+
+    std::uint32_t match_empty() const { return _mm256_movemask_epi8(ctrl_); }
+
+    __m256i ctrl_;
+};
+#endif
+
+template <typename Group>
+class swiss_map {
+public:
+    explicit swiss_map(std::size_t capacity = 16) { allocate(capacity * 8 / 7 + 1); }
+
+    const std::uint64_t *find(std::uint64_t key) const {
+        const std::size_t i = find_index(key);
+        return i == slots_.size() ? nullptr : &slots_[i].value;
+    }
+
+    void insert(std::uint64_t key, std::uint64_t value) {
+        if (const std::size_t i = find_index(key); i != slots_.size()) {
+            slots_[i].value = value;
+            return;
+        }
+        if ((size_ + 1) * 8 > slots_.size() * 7) {
+            grow();
+        }
+        const std::uint64_t h = hash_mix(key);
+        std::size_t g = (h >> 7) & group_mask_;
+        for (std::size_t step = 1;; ++step) {
+            const Group group(ctrl_.data() + g * Group::width);
+            if (const std::uint32_t m = group.match_empty(); m != 0) {
+                const std::size_t i = g * Group::width + __builtin_ctz(m);
+                ctrl_[i] = static_cast<std::int8_t>(h & 0x7f);
+                slots_[i] = {key, value};
+                ++size_;
+                return;
+            }
+            g = (g + step) & group_mask_;
+        }
+    }
+
+    std::size_t size() const { return size_; }
+    std::size_t memory() const { return ctrl_.size() + slots_.size() * sizeof(slot); }
+
+private:
+    static constexpr std::int8_t empty = -128; // 0x80
+
+    struct slot {
+        std::uint64_t key = 0;
+        std::uint64_t value = 0;
+    };
+
+    // index of the slot holding key, or slots_.size() if it isn't in the table
+    std::size_t find_index(std::uint64_t key) const {
+        const std::uint64_t h = hash_mix(key);
+        const auto h2 = static_cast<std::int8_t>(h & 0x7f);
+        std::size_t g = (h >> 7) & group_mask_;
+        for (std::size_t step = 1;; ++step) {
+            const Group group(ctrl_.data() + g * Group::width);
+            for (std::uint32_t m = group.match(h2); m != 0; m &= m - 1) {
+                const std::size_t i = g * Group::width + __builtin_ctz(m);
+                if (slots_[i].key == key) [[likely]] {
+                    return i;
+                }
+            }
+            if (group.match_empty() != 0) [[likely]] {
+                return slots_.size();
+            }
+            g = (g + step) & group_mask_; // triangular probing visits every group
+        }
+    }
+
+    void allocate(std::size_t slots) {
+        std::size_t groups = 1;
+        while (groups * Group::width < slots) {
+            groups *= 2;
+        }
+        group_mask_ = groups - 1;
+        ctrl_.assign(groups * Group::width, empty);
+        slots_.assign(groups * Group::width, slot{});
+        size_ = 0;
+    }
+
+    void grow() {
+        std::vector<std::int8_t> old_ctrl;
+        std::vector<slot> old_slots;
+        old_ctrl.swap(ctrl_);
+        old_slots.swap(slots_);
+        allocate(old_slots.size() * 2);
+        for (std::size_t i = 0; i < old_slots.size(); ++i) {
+            if (old_ctrl[i] != empty) {
+                insert(old_slots[i].key, old_slots[i].value);
+            }
+        }
+    }
+
+    std::vector<std::int8_t> ctrl_;
+    std::vector<slot> slots_;
+    std::size_t group_mask_ = 0;
+    std::size_t size_ = 0;
+};
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,178 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Histogram - conflicting increments - https://en.wikipedia.org/wiki/Histogram
+//
+// ++count in branch_ex_1/2 (branching.cpp) is a histogram with one bin. With more bins,
+// ++bins[in[i]] is a load, add and store to an address that depends on the data. Two elements
+// landing in the same bin close together make the second increment wait on the first: its load
+// has to be forwarded from the store still in flight, several cycles instead of the 1 the add
+// needs. On uniform data neighbouring elements rarely share a bin and the increments overlap; on
+// skewed data (one bin far more common than the rest) they often do, and the loop slows to
+// store forwarding latency. It can't be vectorised either, since lanes of one vector may collide.
+//
+// Privatisation breaks the chain: Copies sub-histograms, element i counted in copy i % Copies,
+// summed at the end. Two increments of the same bin are now Copies elements apart and only wait
+// on each other when they fall in the same copy. The price is Copies x 256 counters of cache
+// (8KB for 8 copies of uint32, still L1) and a merge that doesn't depend on n.
+//
+// 1M uint8 keys, 256 bins, ns per element, g++ 12 -O2 -march=znver4 (bench/histogram.cpp):
+//
+//                              uniform   skewed    constant
+//   histogram_naive            0.21      0.72      0.20
+//   histogram_privatised<2>    0.17      0.38      0.16
+//   histogram_privatised<4>    0.19      0.24      0.15
+//   histogram_privatised<8>    0.21      0.20      0.20
+//
+// Skewed is the bad case, not constant. With every increment on the same address the naive
+// loop still runs at about a cycle an element, so Zen 4 short-cuts the forwarding when the
+// address is predictable (memory renaming, most likely); a random mix of the same and different
+// bins defeats it. 8 copies make skewed data as cheap as uniform, 3.6x the naive loop. The inner
+// loop over the copies needs the unroll pragma: left as a loop at -O2 its counter costs more
+// than the conflicts save.
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include <algorithm>
+#include <cstddef> //size_t
+#include <cstdint>
+
+constexpr std::size_t histogram_bins = 256;
+
+void histogram_naive(const std::uint8_t *in, std::size_t n, std::uint32_t *bins) {
+    std::fill(bins, bins + histogram_bins, 0u);
+    for (std::size_t i = 0; i < n; ++i) {
+        ++bins[in[i]];
+    }
+}
+
+template <std::size_t Copies>
+void histogram_privatised(const std::uint8_t *in, std::size_t n, std::uint32_t *bins) {
+    std::uint32_t copies[Copies][histogram_bins] = {};
+    std::size_t i = 0;
+    for (; i + Copies <= n; i += Copies) {
+#pragma GCC unroll 16
+        for (std::size_t c = 0; c < Copies; ++c) {
+            ++copies[c][in[i + c]];
+        }
+    }
+    for (; i < n; ++i) {
+        ++copies[0][in[i]];
+    }
+    for (std::size_t b = 0; b < histogram_bins; ++b) {
+        std::uint32_t sum = 0;
+        for (std::size_t c = 0; c < Copies; ++c) {
+            sum += copies[c][b];
+        }
+        bins[b] = sum;
+    }
+}
+
+template void histogram_privatised<2>(const std::uint8_t *, std::size_t, std::uint32_t *);
+template void histogram_privatised<4>(const std::uint8_t *, std::size_t, std::uint32_t *);
+template void histogram_privatised<8>(const std::uint8_t *, std::size_t, std::uint32_t *);
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Sort-based histogram
+//
+// Sort the keys and each bin becomes a run: count it in a register and store once per run, so
+// there is no memory dependency at all however skewed the data. The sort costs far more than the
+// conflicts it avoids for a plain count, but it's the shape GPU and database histograms take when
+// the keys are already sorted, or have to be sorted anyway (group by), or the bins are too many to
+// privatise. std::sort on bytes is the worst case for it; for keys this small a counting sort
+// would itself be a histogram.
+//
+// 1M uint8 keys, ns per element, g++ 12 -O2 -march=znver4:
+//
+//                              uniform   skewed    constant
+//   histogram_sorted           28        12.4      5.6
+//   histogram_runs             0.21      0.20      0.20      (already sorted input)
+//
+// The sort is 25-130x the cost of the count. On keys that arrive sorted the run count matches
+// the best privatised histogram, at the cost of a branch per run.
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include <algorithm>
+#include <cstddef> //size_t
+#include <cstdint>
+#include <vector>
+
+// in sorted ascending.
+void histogram_runs(const std::uint8_t *in, std::size_t n, std::uint32_t *bins) {
+    std::fill(bins, bins + histogram_bins, 0u);
+    std::size_t i = 0;
+    while (i < n) {
+        const std::uint8_t key = in[i];
+        const std::size_t begin = i;
+        while (i < n && in[i] == key) {
+            ++i;
+        }
+        bins[key] = static_cast<std::uint32_t>(i - begin);
+    }
+}
+
+void histogram_sorted(const std::uint8_t *in, std::size_t n, std::uint32_t *bins) {
+    std::vector<std::uint8_t> sorted(in, in + n);
+    std::sort(sorted.begin(), sorted.end());
+    histogram_runs(sorted.data(), n, bins);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Parallel histogram (per-thread merge)
+//
+// A shared histogram with atomic increments turns every conflict into cache line ping-pong
+// between cores, and on skewed data every core is fighting over the same line. Privatise per
+// thread instead: each thread counts its chunk into its own histogram (privatised again within
+// the thread), then the per-thread histograms are summed. The merge is threads x 256 adds,
+// nothing next to n. Each thread's counters live on its own stack, so there is no false sharing
+// between them while counting.
+//
+// Like scan_inclusive_parallel (scan.cpp) it starts a thread per chunk every call, so it only
+// pays off for large n.
+//
+// 1M uint8 keys, ns per element, g++ 12 -O2 -march=znver4, measured on a single core (so 1
+// thread: this is the cost of starting it and merging, not the speedup):
+//
+//                              uniform   skewed    constant
+//   histogram_parallel         0.19      0.24      0.15
+//
+// That is the same as the histogram_privatised<4> it calls: a thread start and a 256 bin merge
+// are lost in 1M elements.
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include <algorithm>
+#include <cstddef> //size_t
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+void histogram_parallel(const std::uint8_t *in, std::size_t n, std::uint32_t *bins,
+                        unsigned threads = std::thread::hardware_concurrency()) {
+    threads = std::max(1u, threads);
+    const std::size_t chunk = (n + threads - 1) / threads;
+    std::vector<std::uint32_t> partial(threads * histogram_bins);
+    std::vector<std::thread> pool;
+
+    for (unsigned t = 0; t < threads; ++t) {
+        pool.emplace_back([&, t] {
+            const std::size_t begin = std::min(n, t * chunk);
+            const std::size_t end = std::min(n, begin + chunk);
+            std::uint32_t local[histogram_bins];
+            histogram_privatised<4>(in + begin, end - begin, local);
+            std::copy(local, local + histogram_bins, partial.begin() + t * histogram_bins);
+        });
+    }
+    for (auto &thread : pool) {
+        thread.join();
+    }
+
+    std::fill(bins, bins + histogram_bins, 0u);
+    for (unsigned t = 0; t < threads; ++t) {
+        for (std::size_t b = 0; b < histogram_bins; ++b) {
+            bins[b] += partial[t * histogram_bins + b];
+        }
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
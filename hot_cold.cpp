@@ -0,0 +1,101 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Hot/cold splitting
+//
+// [[likely]]/[[unlikely]] (branching.cpp) decide which side of a branch falls through. They don't
+// shrink anything: the unlikely code is still inside the function, between this function's hot
+// code and the next one's. One function doesn't care, but when the hot set is hundreds of small
+// functions (handlers, visitors, virtual calls) their hot paths end up spread over many more
+// cache lines and pages than they need, and the L1 i-cache (32KB) and iTLB (64 entries of L1 on
+// Zen 4) start to miss.
+//
+// Ways of moving the error path out of the way, weakest first:
+//  - [[unlikely]]: the error path is placed after the hot return, still in the function
+//  - __builtin_expect_with_probability(c, 1, 0.0001): as unlikely, but a low enough probability
+//    makes GCC optimise the block for size (here it stops inlining to_string), 1.5KB -> 440B
+//  - a [[gnu::cold]] [[gnu::noinline]] function for the error path: the hot function is just
+//    the test, the hot return and a jump, and the cold function goes in .text.unlikely, which
+//    the linker groups away from the hot code. 1.5KB -> 29B
+//
+// -freorder-blocks-and-partition (on by default at -O2) splits a function into foo and
+// foo.cold in .text.unlikely, but only for blocks the compiler knows never run. Without a
+// profile (-fprofile-use, see the PGO section) that's only exception cleanup code, so outlining
+// by hand is the way to get the same effect.
+//
+// Sizes below are of one handler<I> compiled on its own with g++ 12 -O2. With 1024 of each in one
+// file (bench/hot_cold.cpp) GCC hits its unit growth limit and inlines less: handle_1 440 bytes,
+// handle_2 ~1.3KB. Called in turn there, handle_4 has about half the L1 i-cache misses of
+// handle_2 and handle_3 and is the fastest of the four.
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include <string>
+
+struct request {
+    int value;
+    int scale;
+};
+
+std::string last_error;
+
+// 1499 bytes
+template <int I>
+int handle_1(const request &r) {
+    if (r.value < 0) {
+        last_error = "handler " + std::to_string(I) + ": bad value " + std::to_string(r.value) +
+                     " scale " + std::to_string(r.scale);
+        return -1;
+    }
+    return r.value * (I + 1) + r.scale;
+}
+
+// 1608 bytes
+template <int I>
+int handle_2(const request &r) {
+    if (r.value < 0) [[unlikely]] {
+        last_error = "handler " + std::to_string(I) + ": bad value " + std::to_string(r.value) +
+                     " scale " + std::to_string(r.scale);
+        return -1;
+    }
+    return r.value * (I + 1) + r.scale;
+}
+
+// 438 bytes
+template <int I>
+int handle_3(const request &r) {
+    if (__builtin_expect_with_probability(r.value < 0, 1, 0.0001)) {
+        last_error = "handler " + std::to_string(I) + ": bad value " + std::to_string(r.value) +
+                     " scale " + std::to_string(r.scale);
+        return -1;
+    }
+    return r.value * (I + 1) + r.scale;
+}
+
+// one copy, shared by every handler, out in .text.unlikely
+[[gnu::cold]] [[gnu::noinline]] int report_error(int handler, const request &r) {
+    last_error = "handler " + std::to_string(handler) + ": bad value " + std::to_string(r.value) +
+                 " scale " + std::to_string(r.scale);
+    return -1;
+}
+
+// 29 bytes
+template <int I>
+int handle_4(const request &r) {
+    if (r.value < 0) {
+        return report_error(I, r);
+    }
+    return r.value * (I + 1) + r.scale;
+}
+
+// int handle_4<5>(request const&):                         // g++ -O2
+//         mov     eax, DWORD PTR [rdi]                     //
+//         test    eax, eax                                 //
+//         js      .L225                                    //
+//         lea     edx, [rax+rax*2]                         //
+//         mov     eax, DWORD PTR [rdi+4]                   //
+//         lea     eax, [rax+rdx*2]                         // the whole hot path in 7 instructions
+//         ret                                              //
+// .L225:                                                   //
+//         mov     rsi, rdi                                 //
+//         mov     edi, 5                                   //
+//         jmp     report_error(int, request const&)        // tail call into the cold code
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
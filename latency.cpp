@@ -0,0 +1,64 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Pointer chasing - measuring memory latency
+//
+// The loop interchange and gather/scatter results depend on how much a miss costs at each level,
+// and datasheet numbers are for the best case. Measure it: make the working set one linked list
+// through every cache line in a buffer, in random order, and follow it. Each load needs the
+// address from the previous one, so nothing overlaps - no out of order execution, no prefetcher
+// (the order is random) - and the time per step is the latency of wherever the buffer lives.
+//
+// Linking the nodes in shuffled order makes a single cycle, so the chase visits every node before
+// repeating, whatever the starting point (a random next pointer per node would make short loops).
+//
+// bench/latency.cpp sweeps the buffer from 4KB to 256MB with 4KB pages and with 2MB (transparent
+// huge) pages, and reports the plateau for each cache level and where 4KB pages start costing
+// extra. On a Zen 4 VM (48KB L1d, 1MB L2, 32MB L3, g++ 12 -O2), two runs:
+//
+//   ns per load           L1d     L2     L3    DRAM
+//   4KB pages            0.80   2.80   10.1 - 10.7   146 - 161
+//   2MB pages            0.80   2.79   10.1 - 10.6   137 - 154
+//
+//   buffer                 512KB    768KB     1MB
+//   4KB pages               3.15     3.79    5.06
+//   2MB pages               2.78     2.79    2.80
+//
+// With 2MB pages L2 latency is flat right up to 1MB; with 4KB pages it climbs from 512KB (the
+// tlb_knee_bytes the bench reports) and is 80% higher at 1MB. Two things: the L1 dTLB covers
+// only 72 4KB pages (288KB), so those loads also go to the L2 dTLB, and 4KB pages are scattered
+// over physical memory, so a buffer the size of L2 doesn't spread evenly over L2's sets (which
+// are picked by physical address). Further out the TLB costs are lost in the noise here: the L3
+// is shared with other tenants of the host, so it falls off at 16MB rather than 32MB, and DRAM
+// latency moves 10% between runs. Run it on the machine the results are for.
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include <algorithm>
+#include <cstddef> //size_t
+#include <cstdint>
+#include <random>
+#include <vector>
+
+// One per cache line, so every step is a different line.
+struct alignas(64) chase_node {
+    chase_node *next;
+};
+
+// Links nodes[0, n) into one cycle in random order.
+void make_cycle(chase_node *nodes, std::size_t n, std::uint64_t seed) {
+    std::vector<std::size_t> order(n);
+    for (std::size_t i = 0; i < n; ++i) {
+        order[i] = i;
+    }
+    std::shuffle(order.begin(), order.end(), std::mt19937_64(seed));
+    for (std::size_t i = 0; i < n; ++i) {
+        nodes[order[i]].next = &nodes[order[(i + 1) % n]];
+    }
+}
+
+const chase_node *chase(const chase_node *p, std::size_t steps) {
+    for (std::size_t i = 0; i < steps; ++i) {
+        p = p->next;
+    }
+    return p;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
@@ -17,18 +17,15 @@
 
 #include <cstddef> //size_t
 
-constexpr std::size_t N = 100;
-
-void loop_unrolling_1() {
-    int a[N];
-    for (std::size_t i = 0; i < N; i++) {
+void loop_unrolling_1(int *a, std::size_t n) {
+    for (std::size_t i = 0; i < n; i++) {
         a[i] = i;
     }
 }
 
-void loop_unrolling_2() {
-    int a[N];
-    for (std::size_t i = 0; i < N; i+=4) {
+// n a multiple of 4
+void loop_unrolling_2(int *a, std::size_t n) {
+    for (std::size_t i = 0; i < n; i+=4) {
         a[i]   = i;
         a[i+1] = i+1;
         a[i+2] = i+2;
@@ -53,14 +50,12 @@ void loop_unrolling_2() {
 
 #include <cstddef> //size_t
 
-constexpr std::size_t N = 100;
-
-void loop_interchange_1() {
-    int a[N][N], b[N][N], c[N][N];
-    for (std::size_t i = 0; i < N; i++) {
-        for (std::size_t j = 0; j < N; j++) {
-            for (std::size_t k = 0; k < N; k++) {
-                a[i][j] = b[i][k] + c[k][j];
+// a and b are rows x n, c is n x n, all row-major
+void loop_interchange_1(int *a, const int *b, const int *c, std::size_t rows, std::size_t n) {
+    for (std::size_t i = 0; i < rows; i++) {
+        for (std::size_t j = 0; j < n; j++) {
+            for (std::size_t k = 0; k < n; k++) {
+                a[i*n + j] += b[i*n + k] + c[k*n + j];
                 // a indexes i then j : row-major
                 // b indexes i then k : row-major
                 // c indexes k then j : column-major
@@ -69,12 +64,11 @@ void loop_interchange_1() {
     }
 }
 
-void loop_interchange_2() {
-    int a[N][N], b[N][N], c[N][N];
-    for (std::size_t i = 0; i < N; i++) {
-        for (std::size_t k = 0; k < N; k++) {
-            for (std::size_t j = 0; j < N; j++) {
-                a[i][j] = b[i][k] + c[k][j];
+void loop_interchange_2(int *a, const int *b, const int *c, std::size_t rows, std::size_t n) {
+    for (std::size_t i = 0; i < rows; i++) {
+        for (std::size_t k = 0; k < n; k++) {
+            for (std::size_t j = 0; j < n; j++) {
+                a[i*n + j] += b[i*n + k] + c[k*n + j];
                 // a indexes i then j : row-major
                 // b indexes i then k : row-major
                 // c indexes k then j : row-major
@@ -109,22 +103,26 @@ void loop_interchange_2() {
 // allows the compiler to vectorise the loop using simd
 ///////////////////////////////////////////////////////////////////////////////////////////////////
 
-int data_dependancy_1(int (&a)[1000], int (&b)[1000], int (&c)[1000]) {
-    for (int i = 0; i <= 998; ++i) {
+#include <cstddef> //size_t
+
+// n >= 2
+int data_dependancy_1(int *a, int *b, const int *c, std::size_t n) {
+    for (std::size_t i = 0; i + 1 < n; ++i) {
         a[i]   += b[i];
         b[i+1] += c[i];
     }
-    return b[999];
+    return b[n-1];
 }
 
-int data_dependancy_2(int (&a)[1000], int (&b)[1000], int (&c)[1000]) {
+int data_dependancy_2(int *a, int *b, const int *c, std::size_t n) {
     a[0] += b[0];
 
-    for (int i = 1; i < 998; ++i) {
+    for (std::size_t i = 0; i + 2 < n; ++i) {
         b[i+1] += c[i];
         a[i+1] += b[i+1];
     }
-    return b[999];
+    b[n-1] += c[n-2];
+    return b[n-1];
 }
 
 ///////////////////////////////////////////////////////////////////////////////////////////////////
\ No newline at end of file
@@ -0,0 +1,10 @@
+#include "caller.h"
+
+#include <cstddef> //size_t
+
+// without LTO: one call to adjust per element
+void adjust_all(std::vector<int> &v, int factor, YesNo clamp) {
+    for (std::size_t i = 0; i < v.size(); ++i) {
+        v[i] = adjust(v[i], factor, clamp);
+    }
+}
@@ -0,0 +1,7 @@
+#pragma once
+
+#include "kernel.h"
+
+#include <vector>
+
+void adjust_all(std::vector<int> &v, int factor, YesNo clamp);
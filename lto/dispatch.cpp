@@ -0,0 +1,12 @@
+#include "dispatch.h"
+
+#include "caller.h"
+
+// with LTO each case can get its own copy of adjust_all with the factor and flag folded in
+void run_stage(stage s, std::vector<int> &v) {
+    switch (s) {
+        case stage::negate: adjust_all(v, -1, YesNo::No); break;
+        case stage::clamp: adjust_all(v, 1, YesNo::Yes); break;
+        case stage::negate_and_clamp: adjust_all(v, -1, YesNo::Yes); break;
+    }
+}
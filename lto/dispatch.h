@@ -0,0 +1,11 @@
+#pragma once
+
+#include <vector>
+
+enum class stage {
+    negate,
+    clamp,
+    negate_and_clamp
+};
+
+void run_stage(stage s, std::vector<int> &v);
@@ -0,0 +1,11 @@
+#include "kernel.h"
+
+#include <algorithm>
+
+int adjust(int x, int factor, YesNo clamp) {
+    x *= factor;
+    if (clamp == YesNo::Yes) {
+        x = std::clamp(x, 0, 1000);
+    }
+    return x;
+}
@@ -0,0 +1,50 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Link time optimisation - cross-TU inlining
+//
+// Everything else in the cheatsheet is one file, so the compiler sees the kernel and its callers
+// together and inlines, folds and vectorises across them. Real code is split over translation
+// units: the compiler sees one .cpp at a time, and a call into another one is just a call. The
+// tricks that rely on inlining - branch_removal<N>, YesNo flags that fold away, loops that
+// vectorise once the body is visible - stop working at the TU boundary, unless the function is
+// in a header (inline or a template) or the program is built with LTO.
+//
+// Three TUs, each a layer of a typical program:
+//  - kernel.cpp    adjust(x, factor, clamp): one element, with a YesNo flag
+//  - caller.cpp    adjust_all(v, factor, clamp): the loop calling the kernel
+//  - dispatch.cpp  run_stage(stage, v): picks the factor and flag for a stage of a pipeline
+//
+// Without LTO every element is a call to adjust and the flag is tested inside it each time.
+// With -flto the compiler writes its intermediate representation into the object files and
+// optimises the whole program at link time. From g++ 12 -flto -fopt-info-inline-optimized:
+//
+//   Inlined adjust/4831 into adjust_all/5155 ... (cross module)
+//   Inlined adjust_all/5542 into run_stage(...).part.0/5541 ... (cross module)
+//
+// so run_stage(stage::negate) becomes a loop of neg instructions with the factor and flag folded
+// away, and the clamp stages call one adjust_all with adjust inlined but the flag still tested.
+// At -O3 the loops are also unswitched and vectorised (g++ 12, -march=znver4):
+//
+//   ns per element (4096 ints)   no LTO, -O2   -flto -O2   no LTO, -O3   -flto -O3
+//   run_stage negate                    0.80        0.20          0.80        0.02
+//   run_stage clamp                     0.80        0.40          0.80        0.02
+//
+// -O3 without LTO gains nothing: the call per element is still there, which is the point.
+// tools/lto.sh builds bench/lto.cpp without LTO, with GCC's LTO and, when clang++ is installed,
+// Clang's ThinLTO (which does the same per module in parallel, importing only the functions worth
+// inlining), and saves each build's cross module inlining decisions next to the timings.
+//
+// The alternatives when LTO isn't an option (it costs link time and memory, and some build
+// systems make it hard): move the hot kernel into a header, or put the loop in the same TU as the
+// kernel so the call crosses the boundary once per array rather than once per element.
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <cstdint>
+
+enum class YesNo : std::uint8_t {
+    Yes,
+    No
+};
+
+int adjust(int x, int factor, YesNo clamp);
@@ -0,0 +1,592 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Matrix views (mdspan) - https://en.cppreference.com/w/cpp/container/mdspan
+//
+// loop_interchange in looping.cpp indexes by hand (a[i*n + j]), which bakes row-major into the
+// kernel: to try column-major, or the kernel on a block of a bigger matrix, the kernel has to be
+// rewritten or the data copied. std::mdspan (C++23) separates the two. It's a pointer plus a
+// layout mapping from indices to an offset, and a kernel written against it takes any layout:
+//  - layout_right   row-major, offset = i*n + j: what C arrays do
+//  - layout_left    column-major, offset = i + j*m: what Fortran, BLAS and Eigen do by default
+//  - layout_stride  offset = i*stride(0) + j*stride(1), with the strides at run time: any view
+//                   whose rows and columns are evenly spaced, such as a sub-matrix (submdspan)
+//
+// The layout is part of the type, so each one gets its own instantiation of the kernel with the
+// index arithmetic inlined - no run time cost over indexing by hand. What the layout doesn't
+// change is which loop order is fast: the innermost loop should walk the index with stride 1
+// (j for layout_right, i for layout_left), as in loop_interchange. matmul picks the order from the
+// layout at compile time; for layout_stride it can only check at run time.
+//
+// libstdc++ 12 has no <mdspan> (it arrived in GCC 14), so a minimal implementation of the part
+// used here is below, with std::mdspan's names. Two differences: elements are a(i, j) rather than
+// a[i, j], which needs C++23, and submdspan only takes (first, last) pairs as slices.
+//
+// 256 x 256 ints, a += b * c, ns per multiply-add (g++ 12 -O3 -march=znver4, bench/matrix.cpp;
+// the layout_stride views are the top left of 512 x 512 row-major matrices):
+//
+//                 layout_right   layout_left   layout_stride
+//   matmul_ijk            0.49          0.59            0.86
+//   matmul_ikj            0.03          3.28            0.03
+//   matmul_jki            3.24          0.03            4.88
+//   matmul                0.03          0.03            0.03
+//
+// The same code is 100x faster or slower depending on whether the loop order matches the layout.
+// The stride 1 order vectorises; the others don't, and jki on layout_right (ikj on layout_left)
+// also walks down columns in the inner loop, a cache line per element. layout_stride keeps up
+// because GCC versions the loop on the stride being 1 at run time (-fversion-loops-for-strides,
+// on at -O3; 0.32 without it). The layout_right kernel is no slower than the same loop indexing
+// a[i*n + j] by hand (0.036). At -O2 nothing vectorises and the stride 1 orders are 0.30-0.32.
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include <array>
+#include <cstddef> //size_t
+#include <limits>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+namespace md {
+
+inline constexpr std::size_t dynamic_extent = std::numeric_limits<std::size_t>::max();
+
+// The size of each dimension, each either fixed at compile time or dynamic_extent (given at run
+// time): extents<std::size_t, 100, 100> is int[100][100]'s shape.
+template <typename IndexType, std::size_t... Exts>
+class extents {
+public:
+    using index_type = IndexType;
+    using rank_type = std::size_t;
+
+    static constexpr rank_type rank() noexcept {
+        return sizeof...(Exts);
+    }
+    static constexpr rank_type rank_dynamic() noexcept {
+        return ((Exts == dynamic_extent) + ... + 0);
+    }
+    static constexpr std::size_t static_extent(rank_type r) noexcept {
+        constexpr std::array<std::size_t, sizeof...(Exts)> e{Exts...};
+        return e[r];
+    }
+
+    constexpr extents() noexcept = default;
+
+    // One value per dynamic extent.
+    template <typename... I>
+        requires(sizeof...(I) == rank_dynamic() && (std::is_convertible_v<I, IndexType> && ...))
+    constexpr explicit extents(I... dynamic) noexcept : dynamic_{static_cast<IndexType>(dynamic)...} {}
+
+    constexpr index_type extent(rank_type r) const noexcept {
+        if (static_extent(r) != dynamic_extent) {
+            return static_cast<index_type>(static_extent(r));
+        }
+        rank_type d = 0;
+        for (rank_type i = 0; i < r; ++i) {
+            d += static_extent(i) == dynamic_extent;
+        }
+        return dynamic_[d];
+    }
+
+private:
+    std::array<IndexType, rank_dynamic()> dynamic_{};
+};
+
+namespace detail {
+
+template <typename IndexType, std::size_t Rank, std::size_t... Exts>
+struct make_dextents : make_dextents<IndexType, Rank - 1, dynamic_extent, Exts...> {};
+
+template <typename IndexType, std::size_t... Exts>
+struct make_dextents<IndexType, 0, Exts...> {
+    using type = extents<IndexType, Exts...>;
+};
+
+} // namespace detail
+
+// All extents dynamic: dextents<std::size_t, 2> is a matrix of any shape.
+template <typename IndexType, std::size_t Rank>
+using dextents = typename detail::make_dextents<IndexType, Rank>::type;
+
+struct layout_right {
+    template <typename Extents>
+    class mapping {
+    public:
+        using index_type = typename Extents::index_type;
+
+        constexpr mapping() noexcept = default;
+        constexpr mapping(const Extents &e) noexcept : extents_(e) {} // NOLINT: implicit, as std
+
+        constexpr const Extents &extents() const noexcept {
+            return extents_;
+        }
+        template <typename... I>
+        constexpr index_type operator()(I... idx) const noexcept {
+            index_type offset = 0;
+            std::size_t r = 0;
+            ((offset = offset * extents_.extent(r++) + static_cast<index_type>(idx)), ...);
+            return offset;
+        }
+        constexpr index_type stride(std::size_t r) const noexcept {
+            index_type s = 1;
+            for (std::size_t i = r + 1; i < Extents::rank(); ++i) {
+                s *= extents_.extent(i);
+            }
+            return s;
+        }
+        constexpr index_type required_span_size() const noexcept {
+            return Extents::rank() == 0 ? 1 : stride(0) * extents_.extent(0);
+        }
+
+    private:
+        Extents extents_{};
+    };
+};
+
+struct layout_left {
+    template <typename Extents>
+    class mapping {
+    public:
+        using index_type = typename Extents::index_type;
+
+        constexpr mapping() noexcept = default;
+        constexpr mapping(const Extents &e) noexcept : extents_(e) {} // NOLINT: implicit, as std
+
+        constexpr const Extents &extents() const noexcept {
+            return extents_;
+        }
+        template <typename... I>
+        constexpr index_type operator()(I... idx) const noexcept {
+            index_type offset = 0, stride = 1;
+            std::size_t r = 0;
+            ((offset += static_cast<index_type>(idx) * stride, stride *= extents_.extent(r++)), ...);
+            return offset;
+        }
+        constexpr index_type stride(std::size_t r) const noexcept {
+            index_type s = 1;
+            for (std::size_t i = 0; i < r; ++i) {
+                s *= extents_.extent(i);
+            }
+            return s;
+        }
+        constexpr index_type required_span_size() const noexcept {
+            return Extents::rank() == 0 ? 1 : stride(Extents::rank() - 1) * extents_.extent(Extents::rank() - 1);
+        }
+
+    private:
+        Extents extents_{};
+    };
+};
+
+struct layout_stride {
+    template <typename Extents>
+    class mapping {
+    public:
+        using index_type = typename Extents::index_type;
+        using strides_type = std::array<index_type, Extents::rank()>;
+
+        constexpr mapping() noexcept = default;
+        constexpr mapping(const Extents &e, const strides_type &s) noexcept : extents_(e), strides_(s) {}
+
+        constexpr const Extents &extents() const noexcept {
+            return extents_;
+        }
+        template <typename... I>
+        constexpr index_type operator()(I... idx) const noexcept {
+            index_type offset = 0;
+            std::size_t r = 0;
+            ((offset += static_cast<index_type>(idx) * strides_[r++]), ...);
+            return offset;
+        }
+        constexpr index_type stride(std::size_t r) const noexcept {
+            return strides_[r];
+        }
+        constexpr index_type required_span_size() const noexcept {
+            index_type size = 1;
+            for (std::size_t r = 0; r < Extents::rank(); ++r) {
+                if (extents_.extent(r) == 0) {
+                    return 0;
+                }
+                size += (extents_.extent(r) - 1) * strides_[r];
+            }
+            return size;
+        }
+
+    private:
+        Extents extents_{};
+        strides_type strides_{};
+    };
+};
+
+// A non-owning view of T elements at p with the given shape and layout. Cheap to copy: pass it by
+// value like a pointer.
+template <typename T, typename Extents, typename LayoutPolicy = layout_right>
+class mdspan {
+public:
+    using extents_type = Extents;
+    using layout_type = LayoutPolicy;
+    using mapping_type = typename LayoutPolicy::template mapping<Extents>;
+    using element_type = T;
+    using index_type = typename Extents::index_type;
+    using data_handle_type = T *;
+    using reference = T &;
+
+    constexpr mdspan() noexcept = default;
+    constexpr mdspan(data_handle_type p, const mapping_type &m) noexcept : ptr_(p), map_(m) {}
+    // mdspan(p, rows, columns) for dynamic extents
+    template <typename... I>
+        requires(sizeof...(I) == Extents::rank_dynamic() && (std::is_convertible_v<I, index_type> && ...))
+    constexpr explicit mdspan(data_handle_type p, I... dynamic) noexcept
+        : ptr_(p), map_(Extents(static_cast<index_type>(dynamic)...)) {}
+
+    template <typename... I>
+        requires(sizeof...(I) == Extents::rank())
+    constexpr reference operator()(I... idx) const noexcept {
+        return ptr_[map_(static_cast<index_type>(idx)...)];
+    }
+
+    static constexpr std::size_t rank() noexcept {
+        return Extents::rank();
+    }
+    constexpr const extents_type &extents() const noexcept {
+        return map_.extents();
+    }
+    constexpr index_type extent(std::size_t r) const noexcept {
+        return extents().extent(r);
+    }
+    constexpr index_type stride(std::size_t r) const noexcept {
+        return map_.stride(r);
+    }
+    constexpr data_handle_type data_handle() const noexcept {
+        return ptr_;
+    }
+    constexpr const mapping_type &mapping() const noexcept {
+        return map_;
+    }
+
+private:
+    data_handle_type ptr_ = nullptr;
+    mapping_type map_{};
+};
+
+namespace detail {
+
+template <typename T, typename E, typename L, typename Slices, std::size_t... R>
+auto submdspan(const mdspan<T, E, L> &m, const Slices &slices, std::index_sequence<R...>) {
+    using sub_extents = dextents<typename E::index_type, E::rank()>;
+    const sub_extents e(std::get<R>(slices).second - std::get<R>(slices).first...);
+    const typename layout_stride::mapping<sub_extents>::strides_type strides{m.stride(R)...};
+    return mdspan<T, sub_extents, layout_stride>(m.data_handle() + m.mapping()(std::get<R>(slices).first...),
+                                                 {e, strides});
+}
+
+} // namespace detail
+
+// The view of [first, last) of each dimension: submdspan(a, std::pair{0, 4}, std::pair{2, 6}) is
+// the 4 x 4 block at row 0, column 2 of a, in a's memory, with a's strides.
+template <typename T, typename E, typename L, typename... Slices>
+    requires(sizeof...(Slices) == E::rank())
+auto submdspan(const mdspan<T, E, L> &m, Slices... slices) {
+    return detail::submdspan(m, std::tuple<Slices...>(slices...), std::make_index_sequence<E::rank()>());
+}
+
+} // namespace md
+
+// a += b * c, for a m x n, b m x p and c p x n. The loops are named by their nesting, outer first.
+template <typename A, typename B, typename C>
+void matmul_ijk(A a, B b, C c) {
+    for (std::size_t i = 0; i < a.extent(0); ++i) {
+        for (std::size_t j = 0; j < a.extent(1); ++j) {
+            for (std::size_t k = 0; k < b.extent(1); ++k) {
+                a(i, j) += b(i, k) * c(k, j);
+            }
+        }
+    }
+}
+
+// Innermost loop walks rows of a and c: stride 1 when they're layout_right.
+template <typename A, typename B, typename C>
+void matmul_ikj(A a, B b, C c) {
+    for (std::size_t i = 0; i < a.extent(0); ++i) {
+        for (std::size_t k = 0; k < b.extent(1); ++k) {
+            for (std::size_t j = 0; j < a.extent(1); ++j) {
+                a(i, j) += b(i, k) * c(k, j);
+            }
+        }
+    }
+}
+
+// Innermost loop walks columns of a and b: stride 1 when they're layout_left.
+template <typename A, typename B, typename C>
+void matmul_jki(A a, B b, C c) {
+    for (std::size_t j = 0; j < a.extent(1); ++j) {
+        for (std::size_t k = 0; k < b.extent(1); ++k) {
+            for (std::size_t i = 0; i < a.extent(0); ++i) {
+                a(i, j) += b(i, k) * c(k, j);
+            }
+        }
+    }
+}
+
+// The order whose inner loop is stride 1 for a's layout (ikj for layouts that aren't strided).
+template <typename A, typename B, typename C>
+void matmul(A a, B b, C c) {
+    using layout = typename A::layout_type;
+    if constexpr (std::is_same_v<layout, md::layout_left>) {
+        matmul_jki(a, b, c);
+    } else if constexpr (std::is_same_v<layout, md::layout_stride>) {
+        if (a.stride(1) <= a.stride(0)) {
+            matmul_ikj(a, b, c);
+        } else {
+            matmul_jki(a, b, c);
+        }
+    } else {
+        matmul_ikj(a, b, c);
+    }
+}
+
+using matrix_right = md::mdspan<int, md::dextents<std::size_t, 2>, md::layout_right>;
+using matrix_left = md::mdspan<int, md::dextents<std::size_t, 2>, md::layout_left>;
+using matrix_stride = md::mdspan<int, md::dextents<std::size_t, 2>, md::layout_stride>;
+
+template void matmul_ijk(matrix_right, matrix_right, matrix_right);
+template void matmul_ikj(matrix_right, matrix_right, matrix_right);
+template void matmul_jki(matrix_right, matrix_right, matrix_right);
+template void matmul(matrix_right, matrix_right, matrix_right);
+template void matmul_ijk(matrix_left, matrix_left, matrix_left);
+template void matmul_ikj(matrix_left, matrix_left, matrix_left);
+template void matmul_jki(matrix_left, matrix_left, matrix_left);
+template void matmul(matrix_left, matrix_left, matrix_left);
+template void matmul_ijk(matrix_stride, matrix_stride, matrix_stride);
+template void matmul_ikj(matrix_stride, matrix_stride, matrix_stride);
+template void matmul_jki(matrix_stride, matrix_stride, matrix_stride);
+template void matmul(matrix_stride, matrix_stride, matrix_stride);
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Morton and tiled layouts - https://en.wikipedia.org/wiki/Z-order_curve
+//
+// Row-major and column-major each favour one direction: a walk along the other one touches a new
+// cache line (and, for big matrices, a new page) every element. Two layouts keep elements that
+// are near in both directions near in memory, as mdspan layout policies so every kernel above
+// works on them unchanged:
+//  - layout_tiled   the matrix is cut into tile x tile blocks, each stored row-major, the blocks
+//                   themselves row-major. A tile sized to fit in L1 is one contiguous chunk
+//  - layout_morton  Z-order: the offset is the bits of i and j interleaved, so every aligned
+//                   2^k x 2^k block is contiguous, at every k at once. No tile size to pick, but
+//                   the matrix is padded to powers of 2 and the offset costs a bit interleave,
+//                   which is two pdep instructions with BMI2 and five shift/mask steps per index
+//                   without
+//
+// Neither is strided, so the compiler can't vectorise a loop over them the way it does for
+// layout_right: the inner loop computes an offset per element. The win is in the memory
+// traffic, and in kernels that work block by block (matmul_blocked), where each block of a tiled
+// or Morton matrix is itself a plain contiguous matrix - block() returns it as one, so the inner
+// kernel is the vectorised layout_right (or Morton) matmul on data that fits in L1.
+//
+// bench/matrix.cpp, 1024 x 1024 ints for the walks and transpose, 512 x 512 for multiply, tile
+// side 64 (from bench/topology.h: the largest power of 2 with three tiles in L1d), ns per element
+// (per multiply-add for the multiplies), g++ 12 -O3 -march=znver4:
+//
+//                    layout_right   layout_left   layout_tiled   layout_morton (shifts)
+//   sum_rows                 0.03          3.16           0.25            0.28   (0.33)
+//   sum_columns              2.55          0.03           0.29            0.28   (0.33)
+//   transpose                5.07          2.92           0.91            0.43   (1.11)
+//   matmul_ikj               0.03          5.01           0.80            0.48   (1.12)
+//   matmul_blocked           0.07          0.07           0.06            0.40   (1.07)
+//
+// Row- and column-major are 100x apart depending on the direction of the walk; tiled and Morton
+// are within 20% of each other in both directions, and transpose, which has to go against the
+// grain of one of the matrices, is 3-12x faster on them. Morton beats tiled at transpose and the
+// unblocked multiply, but only with pdep: with the shift version (-mno-bmi2, in brackets) the
+// interleave costs as much as the cache misses it saves. Beware pdep before Zen 3 on AMD, where
+// it's microcoded and takes hundreds of cycles.
+//
+// The vectorised row-major matmul_ikj still wins the multiply: at 512 x 512 the rows it streams
+// come from L2 fast enough, and matmul_blocked pays for the short inner loops. The tile side is
+// a trade-off too: bigger tiles make matmul_blocked on layout_tiled faster (0.045 at 128, 0.038
+// at 256) and column walks slower (0.47, 0.70) - a tuned GEMM blocks once per cache level.
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include <bit>
+#include <cstddef> //size_t
+#include <cstdint>
+#include <utility>
+#if defined(__BMI2__)
+#include <immintrin.h>
+#endif
+
+// Bits of x moved to the even bit positions: 0b1011 -> 0b01000101.
+inline std::uint64_t spread_bits(std::uint32_t x) {
+    std::uint64_t v = x;
+    v = (v | v << 16) & 0x0000FFFF0000FFFF;
+    v = (v | v << 8) & 0x00FF00FF00FF00FF;
+    v = (v | v << 4) & 0x0F0F0F0F0F0F0F0F;
+    v = (v | v << 2) & 0x3333333333333333;
+    v = (v | v << 1) & 0x5555555555555555;
+    return v;
+}
+
+// j in the even bits, i in the odd ones: 2 x 2 blocks are [(0,0) (0,1) (1,0) (1,1)].
+inline std::uint64_t morton_index(std::uint32_t i, std::uint32_t j) {
+#if defined(__BMI2__)
+    return _pdep_u64(i, 0xAAAAAAAAAAAAAAAA) | _pdep_u64(j, 0x5555555555555555);
+#else
+    return spread_bits(i) << 1 | spread_bits(j);
+#endif
+}
+
+namespace md {
+
+// tile x tile blocks, row-major inside and between them. tile is a power of 2; the extents needn't
+// be multiples of it (the last row and column of tiles are padded).
+struct layout_tiled {
+    template <typename Extents>
+    class mapping {
+        static_assert(Extents::rank() == 2);
+
+    public:
+        using index_type = typename Extents::index_type;
+
+        constexpr mapping() noexcept = default;
+        constexpr mapping(const Extents &e, index_type tile) noexcept
+            : extents_(e), shift_(static_cast<unsigned>(std::countr_zero(tile))),
+              tiles_per_row_((e.extent(1) + tile - 1) >> shift_) {}
+
+        constexpr const Extents &extents() const noexcept {
+            return extents_;
+        }
+        constexpr index_type tile() const noexcept {
+            return index_type{1} << shift_;
+        }
+        template <typename I, typename J>
+        constexpr index_type operator()(I i, J j) const noexcept {
+            const auto r = static_cast<index_type>(i), c = static_cast<index_type>(j);
+            const index_type mask = tile() - 1;
+            return ((r >> shift_) * tiles_per_row_ + (c >> shift_)) << (2 * shift_) | (r & mask) << shift_ |
+                   (c & mask);
+        }
+        constexpr index_type required_span_size() const noexcept {
+            const index_type tile_rows = (extents_.extent(0) + tile() - 1) >> shift_;
+            return tile_rows * tiles_per_row_ << (2 * shift_);
+        }
+
+    private:
+        Extents extents_{};
+        unsigned shift_ = 0;
+        index_type tiles_per_row_ = 0;
+    };
+};
+
+// Z-order. Indices up to 2^32.
+struct layout_morton {
+    template <typename Extents>
+    class mapping {
+        static_assert(Extents::rank() == 2);
+
+    public:
+        using index_type = typename Extents::index_type;
+
+        constexpr mapping() noexcept = default;
+        constexpr mapping(const Extents &e) noexcept : extents_(e) {} // NOLINT: implicit, as std
+
+        constexpr const Extents &extents() const noexcept {
+            return extents_;
+        }
+        template <typename I, typename J>
+        constexpr index_type operator()(I i, J j) const noexcept {
+            return static_cast<index_type>(morton_index(static_cast<std::uint32_t>(i), static_cast<std::uint32_t>(j)));
+        }
+        // Up to the last element: a 2^k x 2^k matrix is exactly 4^k, others are padded.
+        constexpr index_type required_span_size() const noexcept {
+            if (extents_.extent(0) == 0 || extents_.extent(1) == 0) {
+                return 0;
+            }
+            return (*this)(extents_.extent(0) - 1, extents_.extent(1) - 1) + 1;
+        }
+
+    private:
+        Extents extents_{};
+    };
+};
+
+} // namespace md
+
+using matrix_tiled = md::mdspan<int, md::dextents<std::size_t, 2>, md::layout_tiled>;
+using matrix_morton = md::mdspan<int, md::dextents<std::size_t, 2>, md::layout_morton>;
+
+// The size x size block of a at (i, j), as a view in a's memory. i and j are multiples of size.
+// In general that's a strided sub-matrix; for the tiled layout with size == tile it's the tile,
+// and for Morton with size a power of 2 it's a smaller Morton matrix: contiguous either way.
+template <typename T, typename E, typename L>
+auto block(const md::mdspan<T, E, L> &a, std::size_t i, std::size_t j, std::size_t size) {
+    return md::submdspan(a, std::pair{i, i + size}, std::pair{j, j + size});
+}
+
+template <typename T, typename E>
+auto block(const md::mdspan<T, E, md::layout_tiled> &a, std::size_t i, std::size_t j, std::size_t size) {
+    return md::mdspan<T, md::dextents<std::size_t, 2>, md::layout_right>(a.data_handle() + a.mapping()(i, j), size,
+                                                                         size);
+}
+
+template <typename T, typename E>
+auto block(const md::mdspan<T, E, md::layout_morton> &a, std::size_t i, std::size_t j, std::size_t size) {
+    return md::mdspan<T, md::dextents<std::size_t, 2>, md::layout_morton>(a.data_handle() + a.mapping()(i, j), size,
+                                                                          size);
+}
+
+template <typename A>
+int sum_rows(A a) {
+    int sum = 0;
+    for (std::size_t i = 0; i < a.extent(0); ++i) {
+        for (std::size_t j = 0; j < a.extent(1); ++j) {
+            sum += a(i, j);
+        }
+    }
+    return sum;
+}
+
+template <typename A>
+int sum_columns(A a) {
+    int sum = 0;
+    for (std::size_t j = 0; j < a.extent(1); ++j) {
+        for (std::size_t i = 0; i < a.extent(0); ++i) {
+            sum += a(i, j);
+        }
+    }
+    return sum;
+}
+
+// b = a transposed: reads a along rows, writes b along columns.
+template <typename A, typename B>
+void transpose(A a, B b) {
+    for (std::size_t i = 0; i < a.extent(0); ++i) {
+        for (std::size_t j = 0; j < a.extent(1); ++j) {
+            b(j, i) = a(i, j);
+        }
+    }
+}
+
+// matmul one size x size block at a time, so the three blocks being worked on stay in cache. All
+// extents are multiples of size.
+template <typename A, typename B, typename C>
+void matmul_blocked(A a, B b, C c, std::size_t size) {
+    for (std::size_t i = 0; i < a.extent(0); i += size) {
+        for (std::size_t k = 0; k < b.extent(1); k += size) {
+            for (std::size_t j = 0; j < a.extent(1); j += size) {
+                matmul(block(a, i, j, size), block(b, i, k, size), block(c, k, j, size));
+            }
+        }
+    }
+}
+
+template int sum_rows(matrix_tiled);
+template int sum_columns(matrix_tiled);
+template void transpose(matrix_tiled, matrix_tiled);
+template void matmul_ikj(matrix_tiled, matrix_tiled, matrix_tiled);
+template void matmul_blocked(matrix_tiled, matrix_tiled, matrix_tiled, std::size_t);
+template int sum_rows(matrix_morton);
+template int sum_columns(matrix_morton);
+template void transpose(matrix_morton, matrix_morton);
+template void matmul_ikj(matrix_morton, matrix_morton, matrix_morton);
+template void matmul_blocked(matrix_morton, matrix_morton, matrix_morton, std::size_t);
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
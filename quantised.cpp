@@ -0,0 +1,266 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Quantised dot products - int8 and int16 - https://en.wikipedia.org/wiki/Quantization_(signal_processing)
+//
+// Inference tolerates low precision: weights and activations quantised to int8 (or int16) with a
+// scale per tensor or per row, products summed in int32. A 512 bit register holds 16 int32s but
+// 64 int8s, so each instruction does 4x the multiply-adds and each byte of bandwidth carries 4x
+// the values. The catch is that the products have to be widened before they're summed, and x86
+// has dedicated instructions for that:
+//  - pmaddwd (SSE2)       int16 x int16, adjacent pairs of products summed into int32. Exact
+//  - pmaddubsw (SSSE3)    uint8 x int8, adjacent pairs summed into int16 *with saturation*: two
+//                         255 x 127 products are 64770, which saturates to 32767. Widened to int32
+//                         with a pmaddwd by 1s
+//  - vpdpbusd (AVX-512 VNNI, AVX-VNNI)   uint8 x int8, groups of 4 products summed and added to
+//                         int32 lanes in one instruction, no intermediate saturation
+//
+// Both int8 instructions are unsigned x signed. For signed x signed:
+//  - with pmaddubsw, multiply |a| by b with a's sign (psignb): |a| <= 128 and |b| <= 127 keep a
+//    pair within 32512, so nothing saturates (b = -128 is off limits: psignb can't negate it)
+//  - with vpdpbusd, add 128 to a to make it unsigned, and take 128 * sum(b) back off
+//    afterwards. For a matrix the correction depends only on the weights and is computed once
+//
+// Keeping activations to 7 bits (0..127) is the other way out of pmaddubsw's saturation: then a
+// pair is at most 2 * 127 * 128 = 32512.
+//
+// 4096 elements (in L1), ns per multiply-add, g++ 12 -O3 -march=znver4 (bench/quantised.cpp):
+//
+//   dot_i32          0.020     dot_i16          0.015     dot_i8           0.024
+//                              dot_i16_avx2     0.020     dot_i8_avx2      0.011
+//                                                         dot_i8_vnni      0.009
+//                                                         dot_u8i8         0.007
+//                                                         dot_u8i8_avx2    0.010
+//                                                         dot_u8i8_vnni    0.007
+//
+// The scalar loops are the surprise. GCC 12 recognises the uint8 x int8 and int16 x int16
+// patterns and emits vpdpbusd and vpdpwssd itself (the 256 bit AVX-VNNI forms), so dot_u8i8
+// matches the hand written VNNI kernel and dot_i16 beats the pmaddwd one. There is no signed x
+// signed int8 instruction to map dot_i8 onto, so it is sign extended to int16 and multiplied
+// with vpmullw, slower than int16 and even than int32: int8 only pays for signed data with one
+// of the tricks above. On the full uint8 range dot_u8i8_avx2's saturated pairs put it 1.8% out.
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include <cstddef> //size_t
+#include <cstdint>
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+std::int32_t dot_i32(const std::int32_t *a, const std::int32_t *b, std::size_t n) {
+    std::int32_t sum = 0;
+    for (std::size_t i = 0; i < n; ++i) {
+        sum += a[i] * b[i];
+    }
+    return sum;
+}
+
+std::int32_t dot_i16(const std::int16_t *a, const std::int16_t *b, std::size_t n) {
+    std::int32_t sum = 0;
+    for (std::size_t i = 0; i < n; ++i) {
+        sum += a[i] * b[i];
+    }
+    return sum;
+}
+
+std::int32_t dot_i8(const std::int8_t *a, const std::int8_t *b, std::size_t n) {
+    std::int32_t sum = 0;
+    for (std::size_t i = 0; i < n; ++i) {
+        sum += a[i] * b[i];
+    }
+    return sum;
+}
+
+std::int32_t dot_u8i8(const std::uint8_t *a, const std::int8_t *b, std::size_t n) {
+    std::int32_t sum = 0;
+    for (std::size_t i = 0; i < n; ++i) {
+        sum += a[i] * b[i];
+    }
+    return sum;
+}
+
+#if defined(__AVX2__)
+inline std::int32_t horizontal_sum(__m256i v) {
+    const __m128i half = _mm_add_epi32(_mm256_castsi256_si128(v), _mm256_extracti128_si256(v, 1));
+    const __m128i quarter = _mm_add_epi32(half, _mm_shuffle_epi32(half, 0x4E));
+    return _mm_cvtsi128_si32(_mm_add_epi32(quarter, _mm_shuffle_epi32(quarter, 0xB1)));
+}
+
+// n a multiple of 16.
+std::int32_t dot_i16_avx2(const std::int16_t *a, const std::int16_t *b, std::size_t n) {
+    __m256i sum = _mm256_setzero_si256();
+    for (std::size_t i = 0; i < n; i += 16) {
+        const __m256i va = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(a + i));
+        const __m256i vb = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(b + i));
+        sum = _mm256_add_epi32(sum, _mm256_madd_epi16(va, vb));
+    }
+    return horizontal_sum(sum);
+}
+
+// n a multiple of 32, b != -128.
+std::int32_t dot_i8_avx2(const std::int8_t *a, const std::int8_t *b, std::size_t n) {
+    const __m256i ones = _mm256_set1_epi16(1);
+    __m256i sum = _mm256_setzero_si256();
+    for (std::size_t i = 0; i < n; i += 32) {
+        const __m256i va = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(a + i));
+        const __m256i vb = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(b + i));
+        const __m256i pairs = _mm256_maddubs_epi16(_mm256_abs_epi8(va), _mm256_sign_epi8(vb, va));
+        sum = _mm256_add_epi32(sum, _mm256_madd_epi16(pairs, ones));
+    }
+    return horizontal_sum(sum);
+}
+
+// n a multiple of 32. Exact while a[i] * b[i] + a[i+1] * b[i+1] fits in int16 - always, if a is
+// 7 bit - and saturates otherwise.
+std::int32_t dot_u8i8_avx2(const std::uint8_t *a, const std::int8_t *b, std::size_t n) {
+    const __m256i ones = _mm256_set1_epi16(1);
+    __m256i sum = _mm256_setzero_si256();
+    for (std::size_t i = 0; i < n; i += 32) {
+        const __m256i va = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(a + i));
+        const __m256i vb = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(b + i));
+        sum = _mm256_add_epi32(sum, _mm256_madd_epi16(_mm256_maddubs_epi16(va, vb), ones));
+    }
+    return horizontal_sum(sum);
+}
+#endif
+
+#if defined(__AVX512VNNI__) && defined(__AVX512BW__)
+// Not _mm512_reduce_add_epi32 or the 512 bit extracts: in GCC 12 they all trip -Wuninitialized.
+// GCC's vector extensions split the register just as well.
+inline std::int32_t horizontal_sum(__m512i v) {
+    using int32x16 = std::int32_t __attribute__((vector_size(64)));
+    const auto lanes = reinterpret_cast<int32x16>(v);
+    const auto low = __builtin_shufflevector(lanes, lanes, 0, 1, 2, 3, 4, 5, 6, 7);
+    const auto high = __builtin_shufflevector(lanes, lanes, 8, 9, 10, 11, 12, 13, 14, 15);
+    return horizontal_sum(reinterpret_cast<__m256i>(low + high));
+}
+
+// n a multiple of 64.
+std::int32_t dot_u8i8_vnni(const std::uint8_t *a, const std::int8_t *b, std::size_t n) {
+    __m512i sum = _mm512_setzero_si512();
+    for (std::size_t i = 0; i < n; i += 64) {
+        sum = _mm512_dpbusd_epi32(sum, _mm512_loadu_si512(a + i), _mm512_loadu_si512(b + i));
+    }
+    return horizontal_sum(sum);
+}
+
+// n a multiple of 64. (a + 128) . b - 128 * sum(b), the second term also with vpdpbusd.
+std::int32_t dot_i8_vnni(const std::int8_t *a, const std::int8_t *b, std::size_t n) {
+    const __m512i bias = _mm512_set1_epi8(static_cast<char>(0x80));
+    __m512i sum = _mm512_setzero_si512();
+    __m512i correction = _mm512_setzero_si512();
+    for (std::size_t i = 0; i < n; i += 64) {
+        const __m512i vb = _mm512_loadu_si512(b + i);
+        sum = _mm512_dpbusd_epi32(sum, _mm512_xor_si512(_mm512_loadu_si512(a + i), bias), vb);
+        correction = _mm512_dpbusd_epi32(correction, bias, vb);
+    }
+    return horizontal_sum(_mm512_sub_epi32(sum, correction));
+}
+#endif
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Quantised matrix multiply
+//
+// c = a * b for a m x k and b k x n, in int32, int16 and int8, with b stored transposed (n x k)
+// so each element of c is a dot product of two contiguous rows: int8 GEMM libraries repack the
+// weights like this (and further, into the exact order the instructions consume) once, up front.
+// matmul_i8_vnni works on 4 columns of c at a time, so each load of a row of a feeds 4
+// vpdpbusd, and takes the signed correction (128 * the sum of each row of bt) as an input computed
+// once per weight matrix by column_sums.
+//
+// The int32 result goes back to int8 for the next layer: requantise scales it, rounds, and
+// saturates to -128..127 (clamping, not wrapping, so an outlier becomes the largest value
+// rather than a wrong sign).
+//
+// 256 x 1024 times 1024 x 256, ns per multiply-add, g++ 12 -O3 -march=znver4:
+//
+//   matmul_i32       0.035
+//   matmul_i16       0.013     (vpdpwssd, auto-vectorised)
+//   matmul_i8        0.022     (sign extended to int16)
+//   matmul_i8_vnni   0.0064
+//
+// 5.4x int32, more than the 4x the narrower type accounts for, since each load of a row of a
+// feeds 4 columns and the signed correction is already paid for in column_sums. requantise runs
+// at 0.085 ns per element, noise next to the k = 1024 multiply-adds behind each one.
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef> //size_t
+#include <cstdint>
+#if defined(__AVX512VNNI__)
+#include <immintrin.h>
+#endif
+
+template <typename T>
+void matmul_dot(const T *a, const T *bt, std::int32_t *c, std::size_t m, std::size_t n, std::size_t k) {
+    for (std::size_t i = 0; i < m; ++i) {
+        for (std::size_t j = 0; j < n; ++j) {
+            std::int32_t sum = 0;
+            for (std::size_t p = 0; p < k; ++p) {
+                sum += a[i * k + p] * bt[j * k + p];
+            }
+            c[i * n + j] = sum;
+        }
+    }
+}
+
+void matmul_i32(const std::int32_t *a, const std::int32_t *bt, std::int32_t *c, std::size_t m, std::size_t n,
+                std::size_t k) {
+    matmul_dot(a, bt, c, m, n, k);
+}
+
+void matmul_i16(const std::int16_t *a, const std::int16_t *bt, std::int32_t *c, std::size_t m, std::size_t n,
+                std::size_t k) {
+    matmul_dot(a, bt, c, m, n, k);
+}
+
+void matmul_i8(const std::int8_t *a, const std::int8_t *bt, std::int32_t *c, std::size_t m, std::size_t n,
+               std::size_t k) {
+    matmul_dot(a, bt, c, m, n, k);
+}
+
+// 128 * the sum of each row of bt (n x k), for matmul_i8_vnni.
+void column_sums(const std::int8_t *bt, std::int32_t *sums, std::size_t n, std::size_t k) {
+    for (std::size_t j = 0; j < n; ++j) {
+        std::int32_t sum = 0;
+        for (std::size_t p = 0; p < k; ++p) {
+            sum += bt[j * k + p];
+        }
+        sums[j] = 128 * sum;
+    }
+}
+
+#if defined(__AVX512VNNI__) && defined(__AVX512BW__)
+// n a multiple of 4, k a multiple of 64.
+void matmul_i8_vnni(const std::int8_t *a, const std::int8_t *bt, const std::int32_t *sums, std::int32_t *c,
+                    std::size_t m, std::size_t n, std::size_t k) {
+    const __m512i bias = _mm512_set1_epi8(static_cast<char>(0x80));
+    for (std::size_t i = 0; i < m; ++i) {
+        for (std::size_t j = 0; j < n; j += 4) {
+            __m512i c0 = _mm512_setzero_si512(), c1 = c0, c2 = c0, c3 = c0;
+            for (std::size_t p = 0; p < k; p += 64) {
+                const __m512i va = _mm512_xor_si512(_mm512_loadu_si512(a + i * k + p), bias);
+                c0 = _mm512_dpbusd_epi32(c0, va, _mm512_loadu_si512(bt + (j + 0) * k + p));
+                c1 = _mm512_dpbusd_epi32(c1, va, _mm512_loadu_si512(bt + (j + 1) * k + p));
+                c2 = _mm512_dpbusd_epi32(c2, va, _mm512_loadu_si512(bt + (j + 2) * k + p));
+                c3 = _mm512_dpbusd_epi32(c3, va, _mm512_loadu_si512(bt + (j + 3) * k + p));
+            }
+            c[i * n + j + 0] = horizontal_sum(c0) - sums[j + 0];
+            c[i * n + j + 1] = horizontal_sum(c1) - sums[j + 1];
+            c[i * n + j + 2] = horizontal_sum(c2) - sums[j + 2];
+            c[i * n + j + 3] = horizontal_sum(c3) - sums[j + 3];
+        }
+    }
+}
+#endif
+
+// out = clamp(round(c * scale), -128, 127)
+void requantise(const std::int32_t *c, std::int8_t *out, std::size_t n, float scale) {
+    for (std::size_t i = 0; i < n; ++i) {
+        const float scaled = std::nearbyint(static_cast<float>(c[i]) * scale);
+        out[i] = static_cast<std::int8_t>(std::clamp(scaled, -128.0f, 127.0f));
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,233 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Prefix sum (scan) - https://en.wikipedia.org/wiki/Prefix_sum
+//
+// data_dependancy_1/2 in looping.cpp work because the dependency could be moved out of the loop.
+// A running total can't: every out[i] needs out[i-1], so each iteration waits on the add before
+// it. The compiler will not vectorise this loop and it runs at one element per add latency.
+//
+// inclusive: out[i] = in[0] + ... + in[i]
+// exclusive: out[i] = in[0] + ... + in[i-1]   (out[0] = 0)
+//
+// The sections below break the chain up without changing the result (integer addition is
+// associative; floating point is not, so a float scan will give slightly different results).
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include <cstddef> //size_t
+
+void scan_inclusive_1(const int *in, int *out, std::size_t n) {
+    int sum = 0;
+    for (std::size_t i = 0; i < n; ++i) {
+        sum += in[i];
+        out[i] = sum;
+    }
+}
+
+void scan_exclusive_1(const int *in, int *out, std::size_t n) {
+    int sum = 0;
+    for (std::size_t i = 0; i < n; ++i) {
+        out[i] = sum;
+        sum += in[i];
+    }
+}
+
+// scan_inclusive_1(int const*, int*, unsigned long):       //
+//         test    rdx, rdx                                 //
+//         je      .L1                                      //
+//         xor     eax, eax                                 //
+//         xor     ecx, ecx                                 //
+// .L3:                                                     //
+//         add     ecx, DWORD PTR [rdi+rax*4]               // ecx depends on the previous iteration
+//         mov     DWORD PTR [rsi+rax*4], ecx               // scalar store, no simd
+//         add     rax, 1                                   //
+//         cmp     rdx, rax                                 //
+//         jne     .L3                                      //
+// .L1:                                                     //
+//         ret                                              //
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// SIMD scan - in-register shift and add
+//
+// Load a vector, then add it to itself shifted left by 1, 2, 4... elements. After log2(width)
+// steps each lane holds the prefix sum of the vector. Adding the running total of all previous
+// vectors (the carry) gives the final result.
+//
+//   x              [a,     b,       c,         d        ]
+//   x += x << 1    [a,     a+b,     b+c,       c+d      ]
+//   x += x << 2    [a,     a+b,     a+b+c,     a+b+c+d  ]
+//   x + carry      [s+a,   s+a+b,   s+a+b+c,   s+a+b+c+d]
+//
+// Take the broadcast of the vector total from x before the carry is added, then carry += total.
+// That leaves one add per vector on the loop carried chain. Broadcasting from x + carry instead
+// puts the shuffle on the chain too, and that version measured slower than the scalar loop.
+//
+// The shifts are extra work the scalar loop doesn't do, so the gain is less than the vector
+// width; ~2x for SSE and ~2.5x for AVX2, where the shifts only work within 128-bit lanes and an
+// extra cross-lane permute is needed. Both stay ahead of scalar when the data is in DRAM.
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include <cstddef> //size_t
+#include <immintrin.h>
+
+void scan_inclusive_sse(const int *in, int *out, std::size_t n) {
+    __m128i carry = _mm_setzero_si128();
+    std::size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i *>(in + i));
+        x = _mm_add_epi32(x, _mm_slli_si128(x, 4)); // shift by one int
+        x = _mm_add_epi32(x, _mm_slli_si128(x, 8)); // shift by two ints
+        const __m128i total = _mm_shuffle_epi32(x, _MM_SHUFFLE(3, 3, 3, 3));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(out + i), _mm_add_epi32(x, carry));
+        carry = _mm_add_epi32(carry, total); // the only loop carried dependency
+    }
+    int sum = _mm_cvtsi128_si32(carry);
+    for (; i < n; ++i) {
+        sum += in[i];
+        out[i] = sum;
+    }
+}
+
+void scan_exclusive_sse(const int *in, int *out, std::size_t n) {
+    __m128i carry = _mm_setzero_si128();
+    std::size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(in + i));
+        __m128i x = _mm_add_epi32(v, _mm_slli_si128(v, 4));
+        x = _mm_add_epi32(x, _mm_slli_si128(x, 8));
+        const __m128i total = _mm_shuffle_epi32(x, _MM_SHUFFLE(3, 3, 3, 3));
+        // inclusive minus the element itself is the exclusive scan
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(out + i), _mm_add_epi32(_mm_sub_epi32(x, v), carry));
+        carry = _mm_add_epi32(carry, total);
+    }
+    int sum = _mm_cvtsi128_si32(carry);
+    for (; i < n; ++i) {
+        out[i] = sum;
+        sum += in[i];
+    }
+}
+
+#if defined(__AVX2__)
+void scan_inclusive_avx2(const int *in, int *out, std::size_t n) {
+    __m256i carry = _mm256_setzero_si256();
+    std::size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(in + i));
+        x = _mm256_add_epi32(x, _mm256_slli_si256(x, 4)); // shifts are per 128-bit lane
+        x = _mm256_add_epi32(x, _mm256_slli_si256(x, 8));
+        // add the total of the low lane to every element of the high lane
+        __m256i low_total = _mm256_shuffle_epi32(x, _MM_SHUFFLE(3, 3, 3, 3));
+        low_total = _mm256_permute2x128_si256(low_total, low_total, 0x08); // [0, low lane]
+        x = _mm256_add_epi32(x, low_total);
+        const __m256i total = _mm256_permutevar8x32_epi32(x, _mm256_set1_epi32(7));
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(out + i), _mm256_add_epi32(x, carry));
+        carry = _mm256_add_epi32(carry, total);
+    }
+    int sum = _mm256_cvtsi256_si32(carry);
+    for (; i < n; ++i) {
+        sum += in[i];
+        out[i] = sum;
+    }
+}
+#endif
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Parallel scan (reduce then scan)
+//
+// Split the input into one chunk per thread and make two passes:
+//  1. each thread sums its chunk - a reduction, no chain, so it vectorises
+//  2. a serial exclusive scan over the (few) chunk totals gives each chunk its starting offset
+//  3. each thread scans its chunk starting from that offset
+//
+// The input is read twice, so for arrays that don't fit in cache the speedup is capped by memory
+// bandwidth, not the number of cores. It only pays off for large n; below a few hundred thousand
+// elements the cost of starting threads dominates (a real implementation would use a pool).
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include <algorithm>
+#include <cstddef> //size_t
+#include <thread>
+#include <vector>
+
+void scan_inclusive_parallel(const int *in, int *out, std::size_t n,
+                             unsigned threads = std::thread::hardware_concurrency()) {
+    threads = std::max(1u, threads);
+    const std::size_t chunk = (n + threads - 1) / threads;
+    std::vector<int> offsets(threads + 1, 0);
+    std::vector<std::thread> pool;
+
+    for (unsigned t = 0; t < threads; ++t) {
+        pool.emplace_back([&, t] {
+            const std::size_t begin = std::min(n, t * chunk);
+            const std::size_t end = std::min(n, begin + chunk);
+            int sum = 0;
+            for (std::size_t i = begin; i < end; ++i) {
+                sum += in[i];
+            }
+            offsets[t + 1] = sum;
+        });
+    }
+    for (auto &thread : pool) {
+        thread.join();
+    }
+    pool.clear();
+
+    for (unsigned t = 1; t <= threads; ++t) {
+        offsets[t] += offsets[t - 1];
+    }
+
+    for (unsigned t = 0; t < threads; ++t) {
+        pool.emplace_back([&, t] {
+            const std::size_t begin = std::min(n, t * chunk);
+            const std::size_t end = std::min(n, begin + chunk);
+            int sum = offsets[t];
+            for (std::size_t i = begin; i < end; ++i) {
+                sum += in[i];
+                out[i] = sum;
+            }
+        });
+    }
+    for (auto &thread : pool) {
+        thread.join();
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Standard library scan
+//
+// std::partial_sum is specified to run in order. std::inclusive_scan/std::exclusive_scan (C++17)
+// are allowed to reassociate, which is what lets the execution policy overloads run in parallel
+// or vectorised. libstdc++ implements the parallel policies with TBB: if the TBB headers are
+// installed you must link -ltbb, if they aren't the policies quietly fall back to the serial
+// algorithm. Either way measure before assuming par helps - for a scan it does twice the work.
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include <cstddef> //size_t
+#include <execution>
+#include <numeric>
+
+void scan_std_1(const int *in, int *out, std::size_t n) {
+    std::inclusive_scan(in, in + n, out);
+}
+
+void scan_std_2(const int *in, int *out, std::size_t n) {
+    std::inclusive_scan(std::execution::unseq, in, in + n, out);
+}
+
+void scan_std_3(const int *in, int *out, std::size_t n) {
+    std::inclusive_scan(std::execution::par, in, in + n, out);
+}
+
+void scan_std_4(const int *in, int *out, std::size_t n) {
+    std::inclusive_scan(std::execution::par_unseq, in, in + n, out);
+}
+
+void scan_std_exclusive(const int *in, int *out, std::size_t n) {
+    std::exclusive_scan(in, in + n, out, 0);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
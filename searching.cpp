@@ -0,0 +1,249 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Branchless binary search
+//
+// [[likely]]/[[unlikely]] (branching.cpp) help when one side of a branch really is more common.
+// The comparison in a binary search is a coin flip by design, so the predictor is wrong about
+// half the time and every miss throws away the work started down the wrong half.
+//
+// Removing the branch turns the comparison into data (a setcc or cmov). There is nothing left to
+// mispredict, but each step now has to wait for its load to finish before the next address is
+// known, where a speculating branchy search is already loading down whichever half it guessed
+// (and is right half the time). So the branchless version wins while the array is in cache and
+// loses once it's in DRAM. lower_bound_3 gets some of that back by prefetching both halves.
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include <algorithm>
+#include <cstddef> //size_t
+
+const int *lower_bound_1(const int *first, std::size_t n, int value) {
+    return std::lower_bound(first, first + n, value);
+}
+
+const int *lower_bound_2(const int *first, std::size_t n, int value) {
+    if (n == 0) {
+        return first;
+    }
+    // the answer is always in [first, first + n]
+    while (n > 1) {
+        const std::size_t half = n / 2;
+        // written as arithmetic rather than ?: - GCC keeps a ?: as a cmov in this function on its
+        // own, but turns it back into a branch once it's inlined into a caller's loop
+        first += (first[half] < value) * half;
+        n -= half;
+    }
+    return first + (*first < value);
+}
+
+// Prefetch both places the next step could look, so the load is already in flight whichever way
+// the comparison goes. Costs an extra cache line per step that is thrown away half the time.
+const int *lower_bound_3(const int *first, std::size_t n, int value) {
+    if (n == 0) {
+        return first;
+    }
+    while (n > 1) {
+        const std::size_t half = n / 2;
+        __builtin_prefetch(first + half / 2);
+        __builtin_prefetch(first + half + half / 2);
+        first += (first[half] < value) * half;
+        n -= half;
+    }
+    return first + (*first < value);
+}
+
+// lower_bound_2(int const*, unsigned long, int):           //
+//         mov     rax, rdi                                 //
+//         test    rsi, rsi                                 //
+//         je      .L8                                      //
+//         cmp     rsi, 1                                   //
+//         je      .L10                                     //
+// .L11:                                                    //
+//         mov     rax, rsi                                 //
+//         xor     ecx, ecx                                 //
+//         shr     rax                                      // half = n / 2
+//         cmp     DWORD PTR [rdi+rax*4], edx               // first[half] < value
+//         lea     r8, 0[0+rax*4]                           //
+//         setl    cl                                       // ...as 0 or 1, not a jump
+//         sub     rsi, rax                                 // n -= half
+//         imul    rcx, r8                                  //
+//         add     rdi, rcx                                 // first += 0 or half
+//         cmp     rsi, 1                                   // only the loop condition branches,
+//         ja      .L11                                     // and it depends on n alone
+// .L10:                                                    //
+//         xor     eax, eax                                 //
+//         cmp     DWORD PTR [rdi], edx                     //
+//         setl    al                                       //
+//         lea     rax, [rdi+rax*4]                         //
+// .L8:                                                     //
+//         ret                                              //
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Eytzinger layout - https://algorithmica.org/en/eytzinger
+//
+// A sorted array spreads the first few levels of the search far apart: the first compare is at
+// n/2, the next at n/4 or 3n/4 and so on, each on a different cache line and usually a different
+// page. Store the implicit binary tree in breadth first order instead (1-based, children of k at
+// 2k and 2k+1, like a heap):
+//
+//   sorted      [ 1, 2, 3, 4, 5, 6, 7 ]
+//   eytzinger   [ -, 4, 2, 6, 1, 3, 5, 7 ]
+//
+// The top levels of the tree are now packed at the front of the array where they stay in cache,
+// and the 16 descendants of k four levels down are contiguous (16k to 16k + 15): one cache line
+// of ints, as long as the array starts on a line, hence the 64 byte aligned allocator. So we can
+// prefetch that line four iterations before it's needed, whichever way the search goes, hiding
+// most of the memory latency the branchless search above suffers from.
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include <cstddef> //size_t
+#include <cstdint>
+#include <limits>
+#include <new>
+#include <vector>
+
+template <typename T, std::size_t Alignment>
+struct aligned_allocator {
+    using value_type = T;
+    template <typename U>
+    struct rebind {
+        using other = aligned_allocator<U, Alignment>;
+    };
+
+    aligned_allocator() = default;
+    template <typename U>
+    aligned_allocator(const aligned_allocator<U, Alignment> &) {}
+
+    T *allocate(std::size_t n) {
+        return static_cast<T *>(::operator new(n * sizeof(T), std::align_val_t(Alignment)));
+    }
+    void deallocate(T *p, std::size_t) { ::operator delete(p, std::align_val_t(Alignment)); }
+
+    template <typename U>
+    bool operator==(const aligned_allocator<U, Alignment> &) const {
+        return true;
+    }
+};
+
+class eytzinger_array {
+public:
+    explicit eytzinger_array(const std::vector<int> &sorted) : tree_(sorted.size() + 1) {
+        std::size_t i = 0;
+        build(sorted, i, 1);
+    }
+
+    // the smallest element >= value, or INT_MAX if there isn't one
+    int lower_bound(int value) const {
+        const std::size_t n = tree_.size() - 1;
+        std::size_t k = 1;
+        while (k <= n) {
+            // near the leaves 16k is past the end: a pointer there would be UB, an address isn't,
+            // and a prefetch never faults
+            __builtin_prefetch(reinterpret_cast<const void *>(reinterpret_cast<std::uintptr_t>(tree_.data()) +
+                                                              k * 16 * sizeof(int)));
+            k = 2 * k + (tree_[k] < value);
+        }
+        // every right turn (< value) appended a 1 bit, the last left turn is the answer
+        k >>= __builtin_ctzll(~k) + 1;
+        return k == 0 ? std::numeric_limits<int>::max() : tree_[k];
+    }
+
+private:
+    void build(const std::vector<int> &sorted, std::size_t &i, std::size_t k) {
+        if (k < tree_.size()) {
+            build(sorted, i, 2 * k);
+            tree_[k] = sorted[i++];
+            build(sorted, i, 2 * k + 1);
+        }
+    }
+
+    std::vector<int, aligned_allocator<int, 64>> tree_;
+};
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// S-tree (static B-tree) - https://algorithmica.org/en/s-tree
+//
+// Even with prefetching, Eytzinger does one compare per level: log2(n) dependent steps. Put 16
+// keys in each node instead (one 64 byte cache line) and the tree is only log17(n) levels deep.
+// Within a node, one SIMD compare of the search value against all 16 keys and a popcount of the
+// result gives how many keys are smaller, which is the child to descend into:
+//
+//   keys     [ 3, 8, 12, 20, 31, ... ]
+//   x < key  [ 0, 0,  0,  1,  1, ... ]   value = 15 -> 3 keys are smaller -> child 3
+//
+// Node k's children are at k * 17 + 1 ... k * 17 + 17. Nodes are 64 byte aligned so a node
+// is always exactly one cache line. The last node is padded with INT_MAX, so INT_MAX can't be
+// stored as a key.
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include <cstddef> //size_t
+#include <immintrin.h>
+#include <limits>
+#include <vector>
+
+class s_tree {
+public:
+    static constexpr std::size_t B = 16;
+
+    explicit s_tree(const std::vector<int> &sorted) : nodes_((sorted.size() + B - 1) / B) {
+        std::size_t i = 0;
+        build(sorted, i, 0);
+    }
+
+    // the smallest element >= value, or INT_MAX if there isn't one
+    int lower_bound(int value) const {
+        int result = std::numeric_limits<int>::max();
+        std::size_t k = 0;
+        while (k < nodes_.size()) {
+            const std::size_t i = rank(nodes_[k], value);
+            if (i < B) {
+                result = nodes_[k].keys[i];
+            }
+            k = k * (B + 1) + i + 1;
+        }
+        return result;
+    }
+
+private:
+    struct alignas(64) node {
+        int keys[B];
+    };
+
+    // number of keys in the node smaller than value
+    static std::size_t rank(const node &n, int value) {
+#if defined(__AVX512F__)
+        const __m512i keys = _mm512_load_si512(n.keys);
+        return __builtin_popcount(_mm512_cmplt_epi32_mask(keys, _mm512_set1_epi32(value)));
+#elif defined(__AVX2__)
+        const __m256i x = _mm256_set1_epi32(value);
+        const __m256i lo = _mm256_cmpgt_epi32(x, _mm256_load_si256(reinterpret_cast<const __m256i *>(n.keys)));
+        const __m256i hi = _mm256_cmpgt_epi32(x, _mm256_load_si256(reinterpret_cast<const __m256i *>(n.keys + 8)));
+        const unsigned mask = _mm256_movemask_ps(_mm256_castsi256_ps(lo)) |
+                              (_mm256_movemask_ps(_mm256_castsi256_ps(hi)) << 8);
+        return __builtin_popcount(mask);
+#else
+        std::size_t count = 0;
+        for (int key : n.keys) {
+            count += key < value;
+        }
+        return count;
+#endif
+    }
+
+    void build(const std::vector<int> &sorted, std::size_t &i, std::size_t k) {
+        if (k >= nodes_.size()) {
+            return;
+        }
+        for (std::size_t j = 0; j < B; ++j) {
+            build(sorted, i, k * (B + 1) + j + 1);
+            nodes_[k].keys[j] = i < sorted.size() ? sorted[i++] : std::numeric_limits<int>::max();
+        }
+        build(sorted, i, k * (B + 1) + B + 1);
+    }
+
+    std::vector<node> nodes_;
+};
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
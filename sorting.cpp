@@ -0,0 +1,338 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Branchless partition (Lomuto, BlockQuicksort) - https://arxiv.org/abs/1604.06697
+//
+// Quicksort spends its time partitioning, and a partition is a branch per element on x < pivot.
+// With a good pivot that branch is a coin toss: half of them mispredict, at ~15 cycles each, which
+// is more than the rest of the work put together. The same trick as filter_branchless
+// (filter.cpp) removes it: always do the writes, and advance by the result of the compare.
+//
+//  - partition_lomuto_branchless: swap a[i] with a[j] every iteration and bump j if a[i] was
+//    smaller. [0, j) < pivot and [j, i] >= pivot after each step; one loop, no branch but the
+//    loop's, two stores per element
+//  - partition_block (BlockQuicksort): Hoare's scheme from both ends, a block of 64 at a time.
+//    A first branchless loop writes the offset of every element on the wrong side to a buffer
+//    (offsets[count] = i; count += wrong), then the buffered pairs are swapped; the swap loop's
+//    trip count is data dependent but mispredicts once per block, not once per element. What's
+//    left in the middle (< 2 blocks) goes to the Lomuto loop
+//
+// std::partition is the branchy reference. Each partitions around x < pivot and returns the
+// number of elements smaller than the pivot.
+//
+// 1M random ints, pivot the median, ns and branch misses per element (including copying the
+// input back each call), g++ 12 -O2 -march=znver4 (bench/sorting.cpp):
+//
+//                                  ns      misses
+//   partition_std                  2.8     0.50
+//   partition_lomuto_branchless    0.49    0.00
+//   partition_block                0.55    0.018
+//
+// Exactly the coin toss: std::partition mispredicts every other element and is 5.7x slower.
+// The simpler Lomuto loop edges out the block partition here: it moves every element, but the
+// block partition's offset buffers and second pass over them cost more than the moves they save
+// for ints. With larger elements, where a move is expensive, the balance tips the other way.
+// 0.018 misses per element is the swap loop's exit, about once per block.
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include <algorithm>
+#include <cstddef> //size_t, ptrdiff_t
+#include <cstdint>
+#include <utility>
+
+std::size_t partition_std(int *a, std::size_t n, int pivot) {
+    return static_cast<std::size_t>(std::partition(a, a + n, [pivot](int x) { return x < pivot; }) - a);
+}
+
+std::size_t partition_lomuto_branchless(int *a, std::size_t n, int pivot) {
+    std::size_t j = 0;
+    for (std::size_t i = 0; i < n; ++i) {
+        const int x = a[i];
+        const bool smaller = x < pivot;
+        a[i] = a[j];
+        a[j] = x;
+        j += smaller;
+    }
+    return j;
+}
+
+std::size_t partition_block(int *a, std::size_t n, int pivot) {
+    constexpr std::size_t block = 64;
+    std::uint8_t offsets_l[block], offsets_r[block];
+    std::size_t count_l = 0, count_r = 0, start_l = 0, start_r = 0;
+    int *l = a, *r = a + n;
+    while (r - l > static_cast<std::ptrdiff_t>(2 * block)) {
+        if (count_l == 0) {
+            start_l = 0;
+            for (std::size_t i = 0; i < block; ++i) {
+                offsets_l[count_l] = static_cast<std::uint8_t>(i);
+                count_l += !(l[i] < pivot);
+            }
+        }
+        if (count_r == 0) {
+            start_r = 0;
+            for (std::size_t i = 0; i < block; ++i) {
+                offsets_r[count_r] = static_cast<std::uint8_t>(i);
+                count_r += *(r - 1 - static_cast<std::ptrdiff_t>(i)) < pivot;
+            }
+        }
+        const std::size_t swaps = std::min(count_l, count_r);
+        for (std::size_t k = 0; k < swaps; ++k) {
+            std::swap(l[offsets_l[start_l + k]], *(r - 1 - offsets_r[start_r + k]));
+        }
+        count_l -= swaps;
+        count_r -= swaps;
+        start_l += swaps;
+        start_r += swaps;
+        if (count_l == 0) {
+            l += block;
+        }
+        if (count_r == 0) {
+            r -= block;
+        }
+    }
+    // everything before l is < pivot and everything from r is >= pivot, including any block
+    // left half swapped
+    const auto done = static_cast<std::size_t>(l - a);
+    return done + partition_lomuto_branchless(l, static_cast<std::size_t>(r - l), pivot);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Sorting networks (AVX-512) - https://en.wikipedia.org/wiki/Bitonic_sorter
+//
+// Below a few dozen elements std::sort switches to insertion sort, which is a mispredicted
+// branch for most elements of random data. A sorting network is a fixed sequence of
+// compare-exchanges, the same whatever the data: no branches at all, and each step is a min and
+// a max that SIMD does 16 at a time. A 512 bit register holds 16 ints, and a bitonic network
+// sorts them in 10 steps of permute (to line each lane up with its partner), min, and max
+// into the lanes that keep the larger. Two sorted registers merge in 5 more steps (reverse
+// one, min/max across the pair, then 4 in-register steps each), so 32 and 64 elements are 2 and
+// 4 registers sorted and merged.
+//
+// sort_network sorts up to 64 elements, padding the last register with INT_MAX (a masked load,
+// so nothing is read past n). insertion_sort is the scalar reference.
+//
+// Random ints in independent runs of 8 to 64, ns per element (branch misses per element),
+// g++ 12 -O2 -march=znver4:
+//
+//                      8             16            32            64
+//   std::sort          5.4  (0.69)   6.6  (0.90)   11.0 (1.84)   13.9 (2.40)
+//   insertion_sort     5.3  (0.73)   6.6  (0.93)   8.3  (0.95)   12.3 (0.97)
+//   sort_network       0.89 (0.00)   0.30 (0.00)   0.38 (0.00)   0.53 (0.00)
+//
+// 20-30x faster from 16 up. 8 elements cost as much as 16 (half a register of padding) plus the
+// partial store, so per element they're 3x the price, still 6x std::sort.
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include <algorithm>
+#include <bit>
+#include <climits>
+#include <cstddef> //size_t
+#include <cstdint>
+#include <utility>
+#if defined(__AVX512F__)
+#include <immintrin.h>
+#endif
+
+void insertion_sort(int *a, std::size_t n) {
+    for (std::size_t i = 1; i < n; ++i) {
+        const int x = a[i];
+        std::size_t j = i;
+        for (; j > 0 && a[j - 1] > x; --j) {
+            a[j] = a[j - 1];
+        }
+        a[j] = x;
+    }
+}
+
+#if defined(__AVX512F__)
+// GCC's vector extensions rather than _mm512_min_epi32 and friends, which trip GCC 12's
+// -Wmaybe-uninitialized. They compile at least as well: each partner permute becomes a vpshufd
+// (partner within the same 128 bits) or vshufi32x4 (partner 4 or 8 lanes away), cheaper than a
+// vpermd, and the blend folds into the vpmaxsd as a merge mask.
+using int32x16 = std::int32_t __attribute__((vector_size(64)));
+
+inline int32x16 min_16(int32x16 a, int32x16 b) {
+    return a < b ? a : b;
+}
+
+inline int32x16 max_16(int32x16 a, int32x16 b) {
+    return a < b ? b : a;
+}
+
+// Lane i is compared with lane i ^ J. In blocks of K lanes alternately ascending and descending,
+// the higher lane of each pair keeps the max in an ascending block, the lower one in a
+// descending block.
+template <unsigned K, unsigned J, std::size_t... I>
+inline int32x16 bitonic_step(int32x16 v, std::index_sequence<I...>) {
+    const int32x16 other = __builtin_shuffle(v, int32x16{static_cast<std::int32_t>(I ^ J)...});
+    const int32x16 keep_max{(((I & J) != 0) != ((I & K) != 0) ? -1 : 0)...};
+    return keep_max ? max_16(v, other) : min_16(v, other);
+}
+
+template <unsigned K, unsigned J>
+inline int32x16 bitonic_step(int32x16 v) {
+    return bitonic_step<K, J>(v, std::make_index_sequence<16>());
+}
+
+// A bitonic register to ascending.
+inline int32x16 bitonic_merge_16(int32x16 v) {
+    v = bitonic_step<16, 8>(v);
+    v = bitonic_step<16, 4>(v);
+    v = bitonic_step<16, 2>(v);
+    return bitonic_step<16, 1>(v);
+}
+
+inline int32x16 sort_16(int32x16 v) {
+    v = bitonic_step<2, 1>(v);
+    v = bitonic_step<4, 2>(v);
+    v = bitonic_step<4, 1>(v);
+    v = bitonic_step<8, 4>(v);
+    v = bitonic_step<8, 2>(v);
+    v = bitonic_step<8, 1>(v);
+    return bitonic_merge_16(v);
+}
+
+inline int32x16 reverse_16(int32x16 v) {
+    return __builtin_shuffle(v, int32x16{15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0});
+}
+
+// a and b ascending; afterwards a holds the lowest 16 and b the highest, both ascending.
+inline void merge_16(int32x16 &a, int32x16 &b) {
+    const int32x16 reversed = reverse_16(b);
+    const int32x16 lo = min_16(a, reversed);
+    b = bitonic_merge_16(max_16(a, reversed));
+    a = bitonic_merge_16(lo);
+}
+
+// The first lanes of a, INT_MAX in the rest.
+inline int32x16 load_16(const int *a, __mmask16 lanes) {
+    return reinterpret_cast<int32x16>(_mm512_mask_loadu_epi32(_mm512_set1_epi32(INT_MAX), lanes, a));
+}
+
+// Not a masked store: on Zen 4 a 512 bit store with some lanes masked off costs ~30 cycles,
+// more than sorting the register. A full store to the stack and a copy is a few.
+inline void store_16(int *a, __mmask16 lanes, int32x16 v) {
+    if (lanes == 0xFFFF) {
+        _mm512_storeu_si512(a, reinterpret_cast<__m512i>(v));
+        return;
+    }
+    alignas(64) int buffer[16];
+    _mm512_store_si512(buffer, reinterpret_cast<__m512i>(v));
+    std::copy_n(buffer, std::popcount(static_cast<unsigned>(lanes)), a);
+}
+
+// n <= 64.
+void sort_network(int *a, std::size_t n) {
+    const auto lanes = [n](std::size_t r) {
+        const std::size_t left = n > 16 * r ? std::min<std::size_t>(n - 16 * r, 16) : 0;
+        return static_cast<__mmask16>((1u << left) - 1);
+    };
+    if (n <= 16) {
+        store_16(a, lanes(0), sort_16(load_16(a, lanes(0))));
+        return;
+    }
+    if (n <= 32) {
+        int32x16 v0 = sort_16(load_16(a, lanes(0)));
+        int32x16 v1 = sort_16(load_16(a + 16, lanes(1)));
+        merge_16(v0, v1);
+        store_16(a, lanes(0), v0);
+        store_16(a + 16, lanes(1), v1);
+        return;
+    }
+    int32x16 v0 = sort_16(load_16(a, lanes(0)));
+    int32x16 v1 = sort_16(load_16(a + 16, lanes(1)));
+    int32x16 v2 = sort_16(load_16(a + 32, lanes(2)));
+    int32x16 v3 = sort_16(load_16(a + 48, lanes(3)));
+    merge_16(v0, v1);
+    merge_16(v2, v3);
+    // 32 + 32: reverse the second half, min/max at distance 32, then at distance 16
+    const int32x16 r2 = reverse_16(v3), r3 = reverse_16(v2);
+    const int32x16 l0 = min_16(v0, r2), h0 = max_16(v0, r2);
+    const int32x16 l1 = min_16(v1, r3), h1 = max_16(v1, r3);
+    store_16(a, lanes(0), bitonic_merge_16(min_16(l0, l1)));
+    store_16(a + 16, lanes(1), bitonic_merge_16(max_16(l0, l1)));
+    store_16(a + 32, lanes(2), bitonic_merge_16(min_16(h0, h1)));
+    store_16(a + 48, lanes(3), bitonic_merge_16(max_16(h0, h1)));
+}
+#endif
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Hybrid sort
+//
+// Introsort with the pieces above: median of 3 pivot, partition_block, recurse into the smaller
+// side and loop on the larger, and sort_network (insertion_sort without AVX-512) once a range is
+// 64 elements or fewer. Past 2 log2(n) levels of bad pivots it falls back to heapsort, as
+// std::sort does, so the worst case stays O(n log n).
+//
+// Partitioning on x < pivot puts every copy of the pivot on the right, so on data with few
+// distinct values the same pivot comes back forever. When nothing is smaller than the pivot it
+// is the minimum of the range: partition again on x <= pivot (x < pivot + 1, these are ints) and
+// all its copies are done in one pass.
+//
+// 1M ints, ns per element (branch misses per element), g++ 12 -O2 -march=znver4:
+//
+//                      random        nearly sorted   few unique
+//   std::sort          47   (8.5)    7.3  (0.30)     16.2 (2.15)
+//   hybrid_sort        10.4 (0.42)   7.4  (0.23)     3.4  (0.13)
+//
+// 4.5x std::sort on random data, where std::sort takes 8.5 mispredictions per element (about one
+// every other element at each of ~20 levels). On nearly sorted data the branches predict anyway
+// and the two are level. On few unique values std::sort keeps partitioning runs of equal
+// elements; the x <= pivot pass finishes each value in one go, 4.8x faster.
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include <algorithm>
+#include <bit>
+#include <climits>
+#include <cstddef> //size_t
+
+inline int median_of_3(int a, int b, int c) {
+    return std::max(std::min(a, b), std::min(std::max(a, b), c));
+}
+
+inline void small_sort(int *a, std::size_t n) {
+#if defined(__AVX512F__)
+    sort_network(a, n);
+#else
+    insertion_sort(a, n);
+#endif
+}
+
+void hybrid_sort(int *a, std::size_t n, unsigned depth) {
+    while (n > 64) {
+        if (depth-- == 0) {
+            std::make_heap(a, a + n);
+            std::sort_heap(a, a + n);
+            return;
+        }
+        const int pivot = median_of_3(a[0], a[n / 2], a[n - 1]);
+        std::size_t mid = partition_block(a, n, pivot);
+        if (mid == 0) {
+            if (pivot == INT_MAX) {
+                return; // all INT_MAX
+            }
+            mid = partition_block(a, n, pivot + 1);
+            a += mid;
+            n -= mid;
+            continue;
+        }
+        if (mid < n - mid) {
+            hybrid_sort(a, mid, depth);
+            a += mid;
+            n -= mid;
+        } else {
+            hybrid_sort(a + mid, n - mid, depth);
+            n = mid;
+        }
+    }
+    small_sort(a, n);
+}
+
+void hybrid_sort(int *a, std::size_t n) {
+    hybrid_sort(a, n, 2 * static_cast<unsigned>(std::bit_width(n)));
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
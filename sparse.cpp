@@ -0,0 +1,294 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Sparse matrix-vector product (CSR, ELL, SELL-C-sigma) - https://en.wikipedia.org/wiki/Sparse_matrix
+//
+// y = A x for a sparse A. Storing only the nonzeros means storing where they are too, and the
+// format decides the loop order the same way row- vs column-major does in loop_interchange:
+//  - COO         (row, column, value) triples. Easy to build, the input to the others
+//  - CSR         the nonzeros row by row, with row_start[r] the index of row r's first. The
+//                default: no padding, but the inner loop is as long as the row, so short rows
+//                leave SIMD lanes empty and every row pays for a horizontal sum
+//  - ELL         every row padded to the longest, stored column-major (entry k of all rows, then
+//                entry k + 1): the loop over rows is the inner one, long and uniform, so it
+//                vectorises. Wastes memory in proportion to the longest row - one long row and
+//                the matrix is mostly padding
+//  - SELL-C-s    ELL per slice of C rows (C = SIMD width), each slice padded only to its own
+//                longest row. Rows are first sorted by length within windows of s rows so rows
+//                of similar length share a slice; y is written back through the permutation
+//
+// x[column] is a gather whatever the format, so the format can only fix the matrix side: how
+// many bytes per nonzero stream in (8 for column + value, plus padding and row pointers) and how
+// full the SIMD lanes are. SpMV is memory bound once the matrix is bigger than the cache, so
+// bytes per nonzero predict the speed.
+//
+// bench/sparse.cpp, 262144 x 262144, g++ 12 -O2 -march=znver4, GFLOP/s (2 flops per nonzero) and
+// bytes of matrix per nonzero. The matrices are 25-32MB, so they stream from DRAM:
+//
+//                    banded (16/row)   random (16/row)   power-law (12/row average)
+//   spmv_csr             7.0  (8.25)       3.3  (8.25)       2.4  (8.33)
+//   spmv_csr_avx2        7.5               3.8               2.0
+//   spmv_ell             5.2  (8.00)       3.7  (8.00)         -  (40128)
+//   spmv_ell_avx2        6.3               4.3                 -
+//   spmv_sell            8.5  (8.31)       3.2  (8.31)       3.2  (9.24)
+//   spmv_sell_avx2       7.9               4.0               4.0
+//
+// With equal rows (banded, random) ELL and SELL are CSR without the row pointers. On banded the
+// best versions run at 7-8.5 GFLOP/s: 8.5 GFLOP/s at 8.31 bytes per nonzero is 35GB/s, about what
+// memory delivers here. Random columns halve that, the x reads no longer hitting L1.
+//
+// At -O2 GCC 12 vectorises only spmv_sell, whose loop over the C lanes has a fixed trip count: it
+// loads the 8 x values one at a time and inserts them into a vector. That beats vgatherdps when
+// x is in L1 (banded) and loses to it when it isn't (random, power-law). At -O3 it vectorises
+// spmv_csr and spmv_sell with 512 bit gathers as well, and both slow down to about 4.3 GFLOP/s
+// on banded, so the bench builds at -O2.
+//
+// Power-law rows break ELL: the longest row sets the width of all of them, nearly 5000x the
+// memory. CSR survives but its SIMD version loses, most rows being shorter than a vector. SELL
+// gets the lanes full again at about 10% padding, 1.6x faster than CSR - if sigma is large
+// enough to put the long rows together. spmv_sell_avx2 on power-law by sigma (the sigma=
+// variants in bench/sparse.cpp):
+//
+//   sigma                 8      64    1024   262144 (all rows)
+//   bytes per nonzero  31.6    21.5    14.8     9.2
+//   GFLOP/s             1.6     2.1     2.8     4.0
+//
+// Sorting all rows loses any locality the row order had in x and y; it's free here, where the
+// columns are random anyway.
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include <algorithm>
+#include <cstddef> //size_t
+#include <cstdint>
+#include <numeric>
+#include <vector>
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+struct coo_matrix {
+    std::size_t rows = 0, cols = 0;
+    std::vector<std::uint32_t> row, col;
+    std::vector<float> value;
+};
+
+struct csr_matrix {
+    std::size_t rows = 0, cols = 0;
+    std::vector<std::uint32_t> row_start; // rows + 1 entries; row r is [row_start[r], row_start[r + 1])
+    std::vector<std::uint32_t> col;
+    std::vector<float> value;
+};
+
+struct ell_matrix {
+    std::size_t rows = 0, cols = 0, width = 0;
+    std::vector<std::uint32_t> col; // entry k of row r at k * rows + r; padding is column 0, value 0
+    std::vector<float> value;
+};
+
+// Slices of C rows, each stored like an ell_matrix of C rows and its own width.
+struct sell_matrix {
+    static constexpr std::size_t C = 8; // floats per AVX2 register
+
+    std::size_t rows = 0, cols = 0, sigma = 0;
+    std::vector<std::uint32_t> slice_start; // entry k of lane l of slice s at slice_start[s] + k * C + l
+    std::vector<std::uint32_t> slice_width;
+    std::vector<std::uint32_t> row; // the row in lane l of slice s is row[s * C + l]
+    std::vector<std::uint32_t> col;
+    std::vector<float> value;
+};
+
+// Duplicate (row, column) entries are kept, and add up in the product.
+csr_matrix to_csr(const coo_matrix &a) {
+    csr_matrix m{a.rows, a.cols, std::vector<std::uint32_t>(a.rows + 1, 0), std::vector<std::uint32_t>(a.col.size()),
+                 std::vector<float>(a.value.size())};
+    for (const std::uint32_t r : a.row) {
+        ++m.row_start[r + 1];
+    }
+    std::partial_sum(m.row_start.begin(), m.row_start.end(), m.row_start.begin());
+    std::vector<std::uint32_t> next(m.row_start.begin(), m.row_start.end() - 1);
+    for (std::size_t i = 0; i < a.value.size(); ++i) {
+        const std::uint32_t at = next[a.row[i]]++;
+        m.col[at] = a.col[i];
+        m.value[at] = a.value[i];
+    }
+    return m;
+}
+
+// From a row-major dense matrix, keeping the nonzeros.
+csr_matrix to_csr(const float *dense, std::size_t rows, std::size_t cols) {
+    csr_matrix m{rows, cols, {0}, {}, {}};
+    for (std::size_t r = 0; r < rows; ++r) {
+        for (std::size_t c = 0; c < cols; ++c) {
+            if (dense[r * cols + c] != 0.0f) {
+                m.col.push_back(static_cast<std::uint32_t>(c));
+                m.value.push_back(dense[r * cols + c]);
+            }
+        }
+        m.row_start.push_back(static_cast<std::uint32_t>(m.col.size()));
+    }
+    return m;
+}
+
+ell_matrix to_ell(const csr_matrix &a) {
+    ell_matrix m{a.rows, a.cols, 0, {}, {}};
+    for (std::size_t r = 0; r < a.rows; ++r) {
+        m.width = std::max<std::size_t>(m.width, a.row_start[r + 1] - a.row_start[r]);
+    }
+    m.col.assign(m.width * a.rows, 0);
+    m.value.assign(m.width * a.rows, 0.0f);
+    for (std::size_t r = 0; r < a.rows; ++r) {
+        for (std::uint32_t i = a.row_start[r], k = 0; i < a.row_start[r + 1]; ++i, ++k) {
+            m.col[k * a.rows + r] = a.col[i];
+            m.value[k * a.rows + r] = a.value[i];
+        }
+    }
+    return m;
+}
+
+// sigma = 1 keeps the row order; sigma = rows sorts all rows by length. sigma = 0 is taken as 1.
+sell_matrix to_sell(const csr_matrix &a, std::size_t sigma) {
+    constexpr std::size_t C = sell_matrix::C;
+    sigma = std::max<std::size_t>(sigma, 1);
+    sell_matrix m{a.rows, a.cols, sigma, {}, {}, std::vector<std::uint32_t>(a.rows), {}, {}};
+    const auto length = [&](std::uint32_t r) { return a.row_start[r + 1] - a.row_start[r]; };
+    std::iota(m.row.begin(), m.row.end(), 0u);
+    for (std::size_t w = 0; w < a.rows; w += sigma) {
+        const auto window_end = m.row.begin() + static_cast<std::ptrdiff_t>(std::min(a.rows, w + sigma));
+        std::stable_sort(m.row.begin() + static_cast<std::ptrdiff_t>(w), window_end,
+                         [&](std::uint32_t x, std::uint32_t y) { return length(x) > length(y); });
+    }
+    for (std::size_t s = 0; s * C < a.rows; ++s) {
+        const std::size_t lanes = std::min(C, a.rows - s * C);
+        std::uint32_t width = 0;
+        for (std::size_t l = 0; l < lanes; ++l) {
+            width = std::max(width, length(m.row[s * C + l]));
+        }
+        const std::size_t start = m.col.size();
+        m.slice_start.push_back(static_cast<std::uint32_t>(start));
+        m.slice_width.push_back(width);
+        m.col.resize(start + width * C, 0);
+        m.value.resize(start + width * C, 0.0f);
+        for (std::size_t l = 0; l < lanes; ++l) {
+            const std::uint32_t r = m.row[s * C + l];
+            for (std::uint32_t i = a.row_start[r], k = 0; i < a.row_start[r + 1]; ++i, ++k) {
+                m.col[start + k * C + l] = a.col[i];
+                m.value[start + k * C + l] = a.value[i];
+            }
+        }
+    }
+    return m;
+}
+
+void spmv_csr(const csr_matrix &a, const float *x, float *y) {
+    for (std::size_t r = 0; r < a.rows; ++r) {
+        float sum = 0.0f;
+        for (std::uint32_t i = a.row_start[r]; i < a.row_start[r + 1]; ++i) {
+            sum += a.value[i] * x[a.col[i]];
+        }
+        y[r] = sum;
+    }
+}
+
+// Entry k of every row, then entry k + 1: the inner loop runs over rows, contiguous in col,
+// value and y.
+void spmv_ell(const ell_matrix &a, const float *x, float *y) {
+    std::fill(y, y + a.rows, 0.0f);
+    for (std::size_t k = 0; k < a.width; ++k) {
+        const std::uint32_t *col = a.col.data() + k * a.rows;
+        const float *value = a.value.data() + k * a.rows;
+        for (std::size_t r = 0; r < a.rows; ++r) {
+            y[r] += value[r] * x[col[r]];
+        }
+    }
+}
+
+void spmv_sell(const sell_matrix &a, const float *x, float *y) {
+    constexpr std::size_t C = sell_matrix::C;
+    for (std::size_t s = 0; s < a.slice_start.size(); ++s) {
+        float sum[C] = {};
+        const std::uint32_t *col = a.col.data() + a.slice_start[s];
+        const float *value = a.value.data() + a.slice_start[s];
+        for (std::size_t k = 0; k < a.slice_width[s]; ++k) {
+            for (std::size_t l = 0; l < C; ++l) {
+                sum[l] += value[k * C + l] * x[col[k * C + l]];
+            }
+        }
+        for (std::size_t l = 0; l < C && s * C + l < a.rows; ++l) {
+            y[a.row[s * C + l]] = sum[l];
+        }
+    }
+}
+
+#if defined(__AVX2__)
+inline float horizontal_sum(__m256 v) {
+    const __m128 half = _mm_add_ps(_mm256_castps256_ps128(v), _mm256_extractf128_ps(v, 1));
+    const __m128 quarter = _mm_add_ps(half, _mm_movehl_ps(half, half));
+    return _mm_cvtss_f32(_mm_add_ss(quarter, _mm_movehdup_ps(quarter)));
+}
+
+// x[col[0..7]]. vgatherdps merges into its destination, so it waits for whatever last wrote that
+// register: with _mm256_i32gather_ps that was the previous row's horizontal sum, chaining every
+// row of spmv_csr_avx2 to the one before and halving its speed. Merging into a zero breaks the
+// chain, but GCC folds a constant full mask back into the plain gather, hence the asm.
+inline __m256 gather(const float *x, __m256i col) {
+    __m256 all = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+    asm("" : "+x"(all)); // or GCC sees the full mask and drops the zero source again
+    return _mm256_mask_i32gather_ps(_mm256_setzero_ps(), x, col, all, 4);
+}
+
+// 8 nonzeros of a row at a time, the rest of the row scalar, then a horizontal sum per row.
+void spmv_csr_avx2(const csr_matrix &a, const float *x, float *y) {
+    for (std::size_t r = 0; r < a.rows; ++r) {
+        std::uint32_t i = a.row_start[r];
+        const std::uint32_t end = a.row_start[r + 1];
+        __m256 sum = _mm256_setzero_ps();
+        for (; i + 8 <= end; i += 8) {
+            const __m256i col = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(a.col.data() + i));
+            sum = _mm256_fmadd_ps(_mm256_loadu_ps(a.value.data() + i), gather(x, col), sum);
+        }
+        float tail = 0.0f;
+        for (; i < end; ++i) {
+            tail += a.value[i] * x[a.col[i]];
+        }
+        y[r] = horizontal_sum(sum) + tail;
+    }
+}
+
+// spmv_ell 8 rows at a time. Keeping 8 rows' sums in a register across all k instead (as
+// spmv_sell_avx2 does) is 2-3x slower: that reads width streams rows * 4 bytes apart at once.
+void spmv_ell_avx2(const ell_matrix &a, const float *x, float *y) {
+    std::fill(y, y + a.rows, 0.0f);
+    for (std::size_t k = 0; k < a.width; ++k) {
+        const std::uint32_t *col = a.col.data() + k * a.rows;
+        const float *value = a.value.data() + k * a.rows;
+        std::size_t r = 0;
+        for (; r + 8 <= a.rows; r += 8) {
+            const __m256i c = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(col + r));
+            const __m256 product = _mm256_mul_ps(_mm256_loadu_ps(value + r), gather(x, c));
+            _mm256_storeu_ps(y + r, _mm256_add_ps(_mm256_loadu_ps(y + r), product));
+        }
+        for (; r < a.rows; ++r) {
+            y[r] += value[r] * x[col[r]];
+        }
+    }
+}
+
+// One slice per register: its entries are contiguous, so every load is a full vector.
+void spmv_sell_avx2(const sell_matrix &a, const float *x, float *y) {
+    static_assert(sell_matrix::C == 8);
+    for (std::size_t s = 0; s < a.slice_start.size(); ++s) {
+        const std::uint32_t *col = a.col.data() + a.slice_start[s];
+        const float *value = a.value.data() + a.slice_start[s];
+        __m256 sum = _mm256_setzero_ps();
+        for (std::size_t k = 0; k < a.slice_width[s]; ++k) {
+            const __m256i c = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(col + k * 8));
+            sum = _mm256_fmadd_ps(_mm256_loadu_ps(value + k * 8), gather(x, c), sum);
+        }
+        alignas(32) float lanes[8];
+        _mm256_store_ps(lanes, sum);
+        for (std::size_t l = 0; l < 8 && s * 8 + l < a.rows; ++l) {
+            y[a.row[s * 8 + l]] = lanes[l];
+        }
+    }
+}
+#endif
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,72 @@
+#!/bin/sh
+###################################################################################################
+# Link time optimisation builds (see lto/kernel.h)
+#
+# Builds bench/lto.cpp and the three TUs in lto/ without LTO, with -flto and, when clang++ is
+# installed, with Clang's -flto=thin, and runs each. Variants are prefixed with the build, e.g.
+# "[lto] run_stage negate", and written to <out>/timings.csv for tools/report.cpp. Each build's
+# inlining decisions go to <out>/<build>.inline.txt; the ones that cross a TU boundary are
+# printed as well.
+#
+#   tools/lto.sh [out dir, default lto_build]
+#
+# CXX and CXXFLAGS override the compiler and flags (default g++, -std=c++20 -O2 -march=native),
+# e.g. -O3 to see the loops vectorised once they're inlined. The thin LTO build is always clang++.
+###################################################################################################
+
+set -eu
+
+out=${1:-lto_build}
+cxx=${CXX:-g++}
+flags=${CXXFLAGS:--std=c++20 -O2 -march=native}
+sources="bench/lto.cpp lto/kernel.cpp lto/caller.cpp lto/dispatch.cpp"
+
+mkdir -p "$out"
+out=$(cd "$out" && pwd)
+
+# <build> <compiler> <compile flags> <link flags>: compiles each TU on its own, like a build
+# system would, then links
+build() {
+    objects=""
+    for src in $sources; do
+        object="$out/$1.$(basename "$src" .cpp).o"
+        $2 $flags $3 -c -o "$object" "$src"
+        objects="$objects $object"
+    done
+    # shellcheck disable=SC2086 # objects is a list
+    $2 $flags $3 $4 -o "$out/lto_$1" $objects 2> "$out/$1.inline.txt"
+}
+
+# prefix every variant with [build] so all the runs can go into one report
+run() { # <build>
+    "$out/lto_$1" > "$out/$1.timings.csv"
+    awk -F, -v OFS=, -v tag="[$1]" 'NR > 1 || $1 != "section" { $2 = tag " " $2; print }' \
+        "$out/$1.timings.csv" >> "$out/timings.csv"
+}
+
+echo "section,variant,size,ns_per_item" > "$out/timings.csv"
+
+echo "building lto_no_lto" >&2
+build no_lto "$cxx" "" ""
+
+# the link step is where LTO inlines, so that's where the report is asked for
+echo "building lto_lto" >&2
+build lto "$cxx" "-flto" "-fopt-info-inline-optimized"
+
+builds="no_lto lto"
+if command -v clang++ > /dev/null; then
+    echo "building lto_thin_lto" >&2
+    build thin_lto clang++ "-flto=thin" "-fuse-ld=lld -Wl,-mllvm,-pass-remarks=inline"
+    builds="$builds thin_lto"
+else
+    echo "clang++ not found, skipping the ThinLTO build" >&2
+fi
+
+for b in $builds; do
+    echo "cross module inlining in $b:" >&2
+    grep -E "cross module|inlined into" "$out/$b.inline.txt" | grep -Ev "std::|__" >&2 || echo "  none" >&2
+    echo "running lto_$b" >&2
+    run "$b"
+done
+
+echo "results in $out/timings.csv" >&2
@@ -0,0 +1,91 @@
+#!/bin/sh
+###################################################################################################
+# Profile guided layout - PGO and BOLT (https://github.com/llvm/llvm-project/tree/main/bolt)
+#
+# [[likely]], [[gnu::cold]] and friends (branching.cpp, hot_cold.cpp) are guesses written into
+# the source. Once the program can be run on a representative workload, a measured profile does
+# the same job for every branch and function at once:
+#
+#  - PGO (-fprofile-generate, run, -fprofile-use): the compiler knows which blocks and calls are
+#    hot, so it lays out blocks, splits never-run code into foo.cold (-freorder-blocks-and-
+#    partition finally has something to work with) and inlines based on counts
+#  - BOLT: rewrites the linked binary using a perf profile, reordering blocks and functions
+#    across the whole program, including code the compiler never saw (libraries, other TUs).
+#    It needs the binary linked with --emit-relocs, perf, and llvm-bolt/perf2bolt
+#
+# This builds one benchmark four ways and runs each: base, pgo, and (when perf and llvm-bolt are
+# installed) bolt and pgo+bolt. Variants are prefixed with the build, e.g. "[pgo] handle_1", and
+# written to <out>/timings.csv and <out>/counters.csv for tools/report.cpp. Benchmarks that use
+# bench/perf_events.h also report their i-cache/iTLB misses per item.
+#
+#   tools/pgo_bolt.sh [bench/hot_cold.cpp] [out dir, default layout]
+#
+# CXX and CXXFLAGS override the compiler and flags (default g++, -std=c++20 -O2 -march=native).
+###################################################################################################
+
+set -eu
+
+src=${1:-bench/hot_cold.cpp}
+out=${2:-layout}
+cxx=${CXX:-g++}
+flags=${CXXFLAGS:--std=c++20 -O2 -march=native -pthread}
+name=$(basename "$src" .cpp)
+
+mkdir -p "$out/obj"
+out=$(cd "$out" && pwd)
+
+# The object path has to be the same for -fprofile-generate and -fprofile-use: it's how the
+# .gcda file is found.
+build() { # <binary> <extra flags>
+    $cxx $flags $2 -c -o "$out/obj/$name.o" "$src"
+    $cxx $flags $2 -Wl,--emit-relocs -o "$out/$1" "$out/obj/$name.o"
+}
+
+# prefix every variant with [build] so all the runs can go into one report
+run() { # <binary> <build>
+    "$out/$1" > "$out/$2.timings.csv" 2> "$out/$2.counters.csv"
+    awk -F, -v OFS=, -v tag="[$2]" 'NR > 1 || $1 != "section" { $2 = tag " " $2; print }' \
+        "$out/$2.timings.csv" >> "$out/timings.csv"
+    awk -F, -v OFS=, -v tag="[$2]" 'NF == 4 { $2 = tag " " $2; print }' \
+        "$out/$2.counters.csv" >> "$out/counters.csv"
+}
+
+echo "section,variant,size,ns_per_item" > "$out/timings.csv"
+: > "$out/counters.csv"
+
+echo "building ${name}_base" >&2
+build "${name}_base" ""
+
+echo "building ${name}_pgo" >&2
+rm -f "$out/obj/$name.gcda"
+build "${name}_instrumented" "-fprofile-generate -fprofile-update=single"
+"$out/${name}_instrumented" > /dev/null 2>&1
+build "${name}_pgo" "-fprofile-use -fprofile-correction"
+
+builds="base pgo"
+if command -v perf > /dev/null && command -v perf2bolt > /dev/null && command -v llvm-bolt > /dev/null; then
+    for b in base pgo; do
+        echo "building ${name}_${b}_bolt" >&2
+        # branch records (LBR on Intel, BRS on Zen 3+) give BOLT edge counts, without them it
+        # has to infer them from samples (-nl)
+        if perf record -e cycles:u -j any,u -o "$out/$b.perf.data" -- "$out/${name}_$b" > /dev/null 2>&1; then
+            perf2bolt -p "$out/$b.perf.data" -o "$out/$b.fdata" "$out/${name}_$b"
+        else
+            perf record -e cycles:u -o "$out/$b.perf.data" -- "$out/${name}_$b" > /dev/null 2>&1
+            perf2bolt -nl -p "$out/$b.perf.data" -o "$out/$b.fdata" "$out/${name}_$b"
+        fi
+        llvm-bolt "$out/${name}_$b" -o "$out/${name}_${b}_bolt" -data="$out/$b.fdata" \
+            -reorder-blocks=ext-tsp -reorder-functions=hfsort -split-functions -split-all-cold \
+            -split-eh -dyno-stats
+    done
+    builds="$builds base_bolt pgo_bolt"
+else
+    echo "perf, perf2bolt or llvm-bolt not found, skipping the BOLT builds" >&2
+fi
+
+for b in $builds; do
+    echo "running ${name}_$b" >&2
+    run "${name}_$b" "$b"
+done
+
+echo "results in $out/timings.csv and $out/counters.csv" >&2
@@ -0,0 +1,745 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Cheatsheet report generator
+//
+// Produces one self-contained HTML page per section of a cheatsheet source file. Each page shows
+// the source of every variant in the section next to the assembly the compiler generated for it,
+// with each instruction coloured by the source line it came from (taken from the .loc directives
+// emitted with -g), and a table of each function's code size. If timings and/or perf counters
+// are supplied they are added as a table and an inline SVG bar chart. There are no scripts, fonts
+// or stylesheets to fetch, so pages work offline. Sections timed over a working set sweep
+// (bench/sweep.h) get a throughput curve per variant instead of bars, with the knee_*_bytes
+// counters drawn as vertical lines.
+//
+// Build:
+//   g++ -std=c++17 -O2 -o report tools/report.cpp
+//
+// Usage:
+//   report <source.cpp> [--out dir] [--cxx g++] [--flags "-O2 -std=c++20"]
+//                       [--timings timings.csv] [--counters counters.csv]
+//
+// timings.csv  : section,variant,size,ns_per_item   (what bench/bench.h prints)
+// counters.csv : section,variant,event,value        (e.g. from perf stat, one row per event)
+//
+// A section is the block between a banner/comment/banner header and its closing banner, exactly
+// as the cheatsheet files are laid out. Sections are compiled on their own: every line outside
+// the section except #include lines is blanked, so line numbers in the assembly match the file.
+// A section that builds on an earlier one in the same file (and so fails on its own) is compiled
+// again with everything before it kept.
+//
+// Code size is read back from the object file (the assembly is assembled with the same compiler
+// driver and sized with nm). Register spills are counted from the assembly: instructions that
+// access the stack through rsp/rbp, and moves between general purpose and xmm registers (where
+// GCC spills to when tuning for CPUs with fast vmovq). Both also count legitimate uses - locals
+// that live on the stack, a vector reduction's final extract - so compare them between variants
+// of the same kernel rather than reading them as absolutes.
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include <cxxabi.h>
+
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+struct options {
+    fs::path source;
+    fs::path out = "report";
+    std::string cxx = "g++";
+    std::string flags = "-O2 -std=c++20";
+    fs::path timings;
+    fs::path counters;
+};
+
+struct variant {
+    std::string name;
+    std::size_t first_line = 0; // 1-based, inclusive
+    std::size_t last_line = 0;
+};
+
+struct section {
+    std::string title;
+    std::string slug;
+    std::size_t header_first = 0; // 0-based index of the first title/comment line
+    std::size_t body_first = 0;   // 1-based, inclusive
+    std::size_t body_last = 0;    // 1-based, inclusive
+    std::vector<variant> variants;
+};
+
+struct asm_line {
+    std::string text;
+    std::size_t source_line = 0; // 0 when the instruction has no mapping into the source file
+};
+
+struct function_stats {
+    std::size_t bytes = 0; // 0 when the object couldn't be sized
+    std::size_t instructions = 0;
+    std::size_t stack_accesses = 0;
+    std::size_t xmm_moves = 0;
+};
+
+struct timing {
+    std::string variant;
+    std::size_t size = 0;
+    double ns_per_item = 0.0;
+};
+
+struct counter {
+    std::string variant;
+    std::string event;
+    double value = 0.0;
+};
+
+bool is_banner(const std::string &line) {
+    return line.size() > 20 && line.find_first_not_of('/') == std::string::npos;
+}
+
+bool starts_with(const std::string &s, const std::string &prefix) {
+    return s.compare(0, prefix.size(), prefix) == 0;
+}
+
+std::string trim(const std::string &s) {
+    const auto first = s.find_first_not_of(" \t\r");
+    if (first == std::string::npos) {
+        return {};
+    }
+    const auto last = s.find_last_not_of(" \t\r");
+    return s.substr(first, last - first + 1);
+}
+
+std::vector<std::string> split(const std::string &s, char sep) {
+    std::vector<std::string> out;
+    std::string field;
+    std::istringstream in(s);
+    while (std::getline(in, field, sep)) {
+        out.push_back(trim(field));
+    }
+    return out;
+}
+
+std::string slugify(const std::string &title) {
+    // "Loop unrolling - https://..." -> "loop_unrolling", "do {} while (condition)" -> "do_while"
+    std::string base = title.substr(0, title.find(" - "));
+    base = base.substr(0, base.find(" ("));
+    std::string slug;
+    for (char c : base) {
+        if (std::isalnum(static_cast<unsigned char>(c))) {
+            slug += static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+        } else if (!slug.empty() && slug.back() != '_') {
+            slug += '_';
+        }
+    }
+    while (!slug.empty() && slug.back() == '_') {
+        slug.pop_back();
+    }
+    return slug.empty() ? "section" : slug;
+}
+
+std::string escape(const std::string &s) {
+    std::string out;
+    out.reserve(s.size());
+    for (char c : s) {
+        switch (c) {
+            case '&': out += "&amp;"; break;
+            case '<': out += "&lt;"; break;
+            case '>': out += "&gt;"; break;
+            case '"': out += "&quot;"; break;
+            default: out += c;
+        }
+    }
+    return out;
+}
+
+std::string demangle(const std::string &symbol) {
+    int status = 0;
+    std::unique_ptr<char, decltype(&std::free)> name(
+        abi::__cxa_demangle(symbol.c_str(), nullptr, nullptr, &status), &std::free);
+    return status == 0 ? std::string(name.get()) : symbol;
+}
+
+// The bare function name of a demangled signature: "ns::foo<3>(int&)" -> "foo"
+std::string bare_name(const std::string &signature) {
+    std::string s = signature.substr(0, signature.find('('));
+    if (s.find('<') != std::string::npos) {
+        s = s.substr(0, s.find('<'));
+    }
+    // function templates demangle with their return type in front
+    if (s.rfind(' ') != std::string::npos) {
+        s = s.substr(s.rfind(' ') + 1);
+    }
+    const auto colon = s.rfind("::");
+    return colon == std::string::npos ? s : s.substr(colon + 2);
+}
+
+// Colour per source line so an instruction and the line it came from share a background.
+std::string line_colour(std::size_t line) {
+    if (line == 0) {
+        return "transparent";
+    }
+    const unsigned hue = static_cast<unsigned>((line * 47) % 360);
+    return "hsl(" + std::to_string(hue) + ",70%,88%)";
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Source parsing
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+// A function definition starts at column 0 and its signature line ends with '{'. Lines starting
+// with a comment, preprocessor directive, closing brace or whitespace are never definitions.
+bool definition_name(const std::string &line, std::string &name) {
+    if (line.empty() || line.back() != '{' || line.find('(') == std::string::npos) {
+        return false;
+    }
+    const char first = line.front();
+    if (first == '/' || first == '#' || first == '}' || first == ' ' || first == '\t') {
+        return false;
+    }
+    if (starts_with(line, "struct") || starts_with(line, "class") || starts_with(line, "namespace") ||
+        starts_with(line, "enum") || starts_with(line, "union")) {
+        return false;
+    }
+    std::string head = line.substr(0, line.find('('));
+    if (head.find('<') != std::string::npos && head.back() == '>') {
+        head = head.substr(0, head.find('<', head.find_last_of(" *&") + 1));
+    }
+    const auto start = head.find_last_of(" *&:");
+    name = trim(start == std::string::npos ? head : head.substr(start + 1));
+    return !name.empty() && name != "operator";
+}
+
+std::vector<section> parse_sections(const std::vector<std::string> &lines) {
+    std::vector<section> sections;
+    std::size_t i = 0;
+    while (i < lines.size()) {
+        // header: banner, one or more comment lines, banner
+        if (!is_banner(lines[i]) || i + 1 >= lines.size() || !starts_with(lines[i + 1], "//") ||
+            is_banner(lines[i + 1])) {
+            ++i;
+            continue;
+        }
+        section s;
+        s.header_first = i + 1;
+        s.title = trim(lines[i + 1].substr(2));
+        std::size_t j = i + 1;
+        while (j < lines.size() && !is_banner(lines[j])) {
+            ++j;
+        }
+        s.body_first = j + 2;
+        std::size_t k = j + 1;
+        while (k < lines.size() && !is_banner(lines[k])) {
+            ++k;
+        }
+        s.body_last = k; // the closing banner is at index k, so the last body line is k (1-based)
+        s.slug = slugify(s.title);
+
+        for (std::size_t l = s.body_first - 1; l < s.body_last; ++l) {
+            std::string name;
+            if (!definition_name(lines[l], name)) {
+                continue;
+            }
+            variant v{name, l + 1, l + 1};
+            for (std::size_t e = l + 1; e < s.body_last; ++e) {
+                if (starts_with(lines[e], "}")) {
+                    v.last_line = e + 1;
+                    break;
+                }
+            }
+            s.variants.push_back(v);
+        }
+        sections.push_back(s);
+        i = k + 1;
+    }
+
+    // two sections may share a title prefix, keep slugs unique so pages don't overwrite each other
+    std::map<std::string, int> seen;
+    for (auto &s : sections) {
+        if (const int n = seen[s.slug]++; n > 0) {
+            s.slug += "_" + std::to_string(n + 1);
+        }
+    }
+    return sections;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Assembly
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+// Keep instructions and local jump targets, drop assembler directives and debug labels.
+bool keep_asm_line(const std::string &line) {
+    const std::string t = trim(line);
+    if (t.empty() || t[0] == '#') {
+        return false;
+    }
+    if (t[0] == '.') {
+        // .L3: is a jump target, .LFB0:/.LVL1:/.LBB2: are debug bookkeeping
+        return t.back() == ':' && t.size() > 3 && t[1] == 'L' && std::isdigit(static_cast<unsigned char>(t[2]));
+    }
+    return true;
+}
+
+bool is_gpr(const std::string &operand) {
+    static const char *const names[] = {"rax", "rbx", "rcx", "rdx", "rsi", "rdi", "rbp", "rsp", "eax",
+                                        "ebx", "ecx", "edx", "esi", "edi", "ebp", "esp"};
+    if (std::find(std::begin(names), std::end(names), operand) != std::end(names)) {
+        return true;
+    }
+    // r8 ... r15 and their 32-bit halves r8d ... r15d
+    return operand.size() >= 2 && operand[0] == 'r' && std::isdigit(static_cast<unsigned char>(operand[1])) &&
+           operand.find_first_not_of("0123456789", 1) >= operand.size() - 1;
+}
+
+// Adds one instruction (already trimmed, intel syntax) to the spill heuristics.
+void count_instruction(const std::string &t, function_stats &stats) {
+    ++stats.instructions;
+    const std::string mnemonic = t.substr(0, t.find_first_of(" \t"));
+    const std::string operands = trim(t.substr(mnemonic.size()));
+    if (mnemonic != "lea" && operands.find("PTR") != std::string::npos &&
+        (operands.find("[rsp") != std::string::npos || operands.find("rsp]") != std::string::npos ||
+         operands.find("[rbp") != std::string::npos || operands.find("rbp]") != std::string::npos)) {
+        ++stats.stack_accesses;
+    }
+    if (mnemonic == "vmovq" || mnemonic == "movq" || mnemonic == "vmovd" || mnemonic == "movd") {
+        const auto ops = split(operands, ',');
+        if (ops.size() == 2 && (is_gpr(ops[0]) != is_gpr(ops[1])) &&
+            (starts_with(ops[0], "xmm") || starts_with(ops[1], "xmm"))) {
+            ++stats.xmm_moves;
+        }
+    }
+}
+
+// Assembles the section's .s and reads each function's size with nm.
+void read_sizes(const options &opt, const fs::path &assembly, const fs::path &work, const section &s,
+                std::map<std::string, function_stats> &stats) {
+    const fs::path object = work / (s.slug + ".o");
+    const fs::path sizes = work / (s.slug + ".sizes");
+    const std::string cmd = opt.cxx + " -c -x assembler -o \"" + object.string() + "\" \"" + assembly.string() +
+                            "\" 2> /dev/null && nm -S --defined-only \"" + object.string() + "\" > \"" +
+                            sizes.string() + "\" 2> /dev/null";
+    if (std::system(cmd.c_str()) != 0) {
+        return;
+    }
+    std::ifstream f(sizes);
+    std::string address, size, type, symbol;
+    while (f >> address >> size >> type >> symbol) {
+        if (type == "T" || type == "t" || type == "W" || type == "w") {
+            const auto it = stats.find(demangle(symbol));
+            if (it != stats.end()) {
+                it->second.bytes = std::stoul(size, nullptr, 16);
+            }
+        }
+    }
+}
+
+std::map<std::string, std::vector<asm_line>> compile_section(const options &opt,
+                                                             const std::vector<std::string> &lines,
+                                                             const section &s, const fs::path &work,
+                                                             bool keep_preceding, std::string &error,
+                                                             std::map<std::string, function_stats> &stats) {
+    const fs::path src = work / (s.slug + ".cpp");
+    const fs::path out = work / (s.slug + ".s");
+    const fs::path err = work / (s.slug + ".err");
+    stats.clear();
+    {
+        std::ofstream f(src);
+        for (std::size_t l = 0; l < lines.size(); ++l) {
+            const bool inside = (keep_preceding || l + 1 >= s.body_first) && l + 1 <= s.body_last;
+            f << (inside || starts_with(lines[l], "#include") ? lines[l] : std::string()) << '\n';
+        }
+    }
+    const std::string cmd = opt.cxx + " " + opt.flags +
+                            " -S -g -masm=intel -fno-asynchronous-unwind-tables -o \"" + out.string() +
+                            "\" \"" + src.string() + "\" 2> \"" + err.string() + "\"";
+    std::map<std::string, std::vector<asm_line>> functions;
+    if (std::system(cmd.c_str()) != 0) {
+        std::ifstream f(err);
+        error.assign(std::istreambuf_iterator<char>(f), std::istreambuf_iterator<char>());
+        return functions;
+    }
+
+    std::ifstream f(out);
+    std::string line;
+    std::map<int, bool> is_source_file; // .file index -> refers to the section source
+    std::string current;
+    std::size_t current_line = 0;
+    while (std::getline(f, line)) {
+        const std::string t = trim(line);
+        if (starts_with(t, ".file")) {
+            std::istringstream in(t.substr(5));
+            int index = -1;
+            if (in >> index) {
+                is_source_file[index] = t.find(src.filename().string() + "\"") != std::string::npos;
+            }
+        } else if (starts_with(t, ".loc")) {
+            std::istringstream in(t.substr(4));
+            int file = 0;
+            std::size_t l = 0;
+            in >> file >> l;
+            current_line = is_source_file[file] ? l : 0;
+        } else if (starts_with(t, ".size") && !current.empty()) {
+            current.clear();
+        } else if (!line.empty() && line[0] != '\t' && line[0] != '.' && t.back() == ':') {
+            current = demangle(t.substr(0, t.size() - 1));
+            current_line = 0;
+            functions[current].push_back({current + ":", 0});
+            stats[current];
+        } else if (!current.empty() && keep_asm_line(line)) {
+            const bool label = t.back() == ':';
+            functions[current].push_back({label ? t : "        " + t, label ? 0 : current_line});
+            if (!label) {
+                count_instruction(t, stats[current]);
+            }
+        }
+    }
+    read_sizes(opt, out, work, s, stats);
+    return functions;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Measurements
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+std::vector<std::vector<std::string>> read_csv(const fs::path &path) {
+    std::vector<std::vector<std::string>> rows;
+    if (path.empty()) {
+        return rows;
+    }
+    std::ifstream f(path);
+    if (!f) {
+        std::cerr << "warning: cannot read " << path << '\n';
+        return rows;
+    }
+    std::string line;
+    while (std::getline(f, line)) {
+        if (!trim(line).empty() && line[0] != '#') {
+            rows.push_back(split(line, ','));
+        }
+    }
+    return rows;
+}
+
+std::map<std::string, std::vector<timing>> read_timings(const fs::path &path) {
+    std::map<std::string, std::vector<timing>> out;
+    for (const auto &row : read_csv(path)) {
+        if (row.size() < 4 || row[0] == "section") {
+            continue;
+        }
+        out[row[0]].push_back({row[1], std::stoul(row[2]), std::stod(row[3])});
+    }
+    return out;
+}
+
+std::map<std::string, std::vector<counter>> read_counters(const fs::path &path) {
+    std::map<std::string, std::vector<counter>> out;
+    for (const auto &row : read_csv(path)) {
+        if (row.size() < 4 || row[0] == "section") {
+            continue;
+        }
+        out[row[0]].push_back({row[1], row[2], std::stod(row[3])});
+    }
+    return out;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// HTML
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+// One group of horizontal bars per problem size, one bar per variant.
+void write_chart(std::ostream &html, const std::vector<timing> &timings) {
+    std::map<std::size_t, std::vector<const timing *>> by_size;
+    double max_ns = 0.0;
+    for (const auto &t : timings) {
+        by_size[t.size].push_back(&t);
+        max_ns = std::max(max_ns, t.ns_per_item);
+    }
+    if (max_ns <= 0.0) {
+        return;
+    }
+    constexpr int label_w = 220, bar_w = 480, bar_h = 18, gap = 4;
+    int rows = 0;
+    for (const auto &group : by_size) {
+        rows += static_cast<int>(group.second.size()) + 1;
+    }
+    const int height = rows * (bar_h + gap) + gap;
+    html << "<svg xmlns='http://www.w3.org/2000/svg' width='" << label_w + bar_w + 100 << "' height='"
+         << height << "' font-family='monospace' font-size='12'>\n";
+    int y = gap;
+    for (const auto &[size, group] : by_size) {
+        html << "<text x='0' y='" << y + 13 << "' font-weight='bold'>n = " << size << "</text>\n";
+        y += bar_h + gap;
+        for (const timing *t : group) {
+            const int w = std::max(1, static_cast<int>(bar_w * t->ns_per_item / max_ns));
+            html << "<text x='8' y='" << y + 13 << "'>" << escape(t->variant) << "</text>"
+                 << "<rect x='" << label_w << "' y='" << y << "' width='" << w << "' height='" << bar_h
+                 << "' fill='hsl(" << (std::hash<std::string>{}(t->variant) % 360) << ",55%,55%)'/>"
+                 << "<text x='" << label_w + w + 4 << "' y='" << y + 13 << "'>" << t->ns_per_item
+                 << " ns</text>\n";
+            y += bar_h + gap;
+        }
+    }
+    html << "</svg>\n";
+}
+
+// A sweep: some variant timed at 8 or more sizes.
+bool is_sweep(const std::vector<timing> &timings) {
+    std::map<std::string, int> sizes;
+    return std::any_of(timings.begin(), timings.end(), [&](const timing &t) { return ++sizes[t.variant] >= 8; });
+}
+
+// Items per ns over log2(size), one line per variant, with a dashed line at each knee counter
+// (knee_<level>_bytes, from bench/sweep.h) in the variant's colour.
+void write_sweep_chart(std::ostream &html, const std::vector<timing> &timings, const std::vector<counter> &counters) {
+    std::map<std::string, std::vector<const timing *>> by_variant;
+    double min_x = 1e300, max_x = 0.0, max_y = 0.0;
+    for (const auto &t : timings) {
+        if (t.size == 0 || t.ns_per_item <= 0.0) {
+            continue;
+        }
+        by_variant[t.variant].push_back(&t);
+        min_x = std::min(min_x, std::log2(static_cast<double>(t.size)));
+        max_x = std::max(max_x, std::log2(static_cast<double>(t.size)));
+        max_y = std::max(max_y, 1.0 / t.ns_per_item);
+    }
+    if (by_variant.empty() || max_x <= min_x) {
+        return;
+    }
+    constexpr int left = 60, plot_w = 720, plot_h = 320, top = 10, legend_h = 18;
+    const auto x_of = [&](double bytes) { return left + plot_w * (std::log2(bytes) - min_x) / (max_x - min_x); };
+    const auto y_of = [&](double per_ns) { return top + plot_h * (1.0 - per_ns / max_y); };
+    const auto colour = [](const std::string &variant) {
+        return "hsl(" + std::to_string(std::hash<std::string>{}(variant) % 360) + ",55%,45%)";
+    };
+    const int height = top + plot_h + 30 + legend_h * static_cast<int>(by_variant.size());
+    html << "<svg xmlns='http://www.w3.org/2000/svg' width='" << left + plot_w + 40 << "' height='" << height
+         << "' font-family='monospace' font-size='12'>\n";
+    html << "<rect x='" << left << "' y='" << top << "' width='" << plot_w << "' height='" << plot_h
+         << "' fill='none' stroke='#ccc'/>\n";
+    html << "<text x='0' y='" << top + 12 << "'>" << max_y << "</text><text x='0' y='" << top + 26
+         << "'>items/ns</text>\n";
+    // one tick per power of 4: 4KB, 16KB, ...
+    for (double b = std::exp2(std::ceil(min_x)); std::log2(b) <= max_x; b *= 4) {
+        const double x = x_of(b);
+        const std::string label = b >= 1 << 20 ? std::to_string(static_cast<long>(b) >> 20) + "MB"
+                                               : std::to_string(static_cast<long>(b) >> 10) + "KB";
+        html << "<line x1='" << x << "' y1='" << top + plot_h << "' x2='" << x << "' y2='" << top + plot_h + 4
+             << "' stroke='#999'/><text x='" << x - 12 << "' y='" << top + plot_h + 16 << "'>" << label
+             << "</text>\n";
+    }
+    for (const auto &c : counters) {
+        if (!starts_with(c.event, "knee_") || c.event.size() < 6 ||
+            c.event.compare(c.event.size() - 6, 6, "_bytes") != 0 || c.value <= 0.0) {
+            continue;
+        }
+        const double x = x_of(c.value);
+        const std::string level = c.event.substr(5, c.event.size() - 11);
+        html << "<line x1='" << x << "' y1='" << top << "' x2='" << x << "' y2='" << top + plot_h << "' stroke='"
+             << colour(c.variant) << "' stroke-dasharray='4,3'/><text x='" << x + 2 << "' y='" << top + plot_h - 4
+             << "' fill='" << colour(c.variant) << "'>" << escape(level) << "</text>\n";
+    }
+    int legend_y = top + plot_h + 30;
+    for (auto &[name, points] : by_variant) {
+        std::sort(points.begin(), points.end(), [](const timing *a, const timing *b) { return a->size < b->size; });
+        html << "<polyline fill='none' stroke-width='2' stroke='" << colour(name) << "' points='";
+        for (const timing *t : points) {
+            html << x_of(static_cast<double>(t->size)) << ',' << y_of(1.0 / t->ns_per_item) << ' ';
+        }
+        html << "'/>\n<rect x='" << left << "' y='" << legend_y + 2 << "' width='12' height='10' fill='"
+             << colour(name) << "'/><text x='" << left + 18 << "' y='" << legend_y + 11 << "'>" << escape(name)
+             << "</text>\n";
+        legend_y += legend_h;
+    }
+    html << "</svg>\n";
+}
+
+void write_counters(std::ostream &html, const std::vector<counter> &counters) {
+    std::vector<std::string> events;
+    std::map<std::string, std::map<std::string, double>> table;
+    for (const auto &c : counters) {
+        if (std::find(events.begin(), events.end(), c.event) == events.end()) {
+            events.push_back(c.event);
+        }
+        table[c.variant][c.event] = c.value;
+    }
+    html << "<table><tr><th>variant</th>";
+    for (const auto &e : events) {
+        html << "<th>" << escape(e) << "</th>";
+    }
+    html << "</tr>\n";
+    for (const auto &[name, values] : table) {
+        html << "<tr><td>" << escape(name) << "</td>";
+        for (const auto &e : events) {
+            const auto it = values.find(e);
+            html << "<td>" << (it == values.end() ? std::string("-") : std::to_string(it->second)) << "</td>";
+        }
+        html << "</tr>\n";
+    }
+    html << "</table>\n";
+}
+
+// One row per compiled function that belongs to a variant of the section.
+void write_code_size(std::ostream &html, const section &s, const std::map<std::string, function_stats> &stats) {
+    std::ostringstream rows;
+    for (const auto &[signature, st] : stats) {
+        const std::string name = bare_name(signature);
+        if (std::none_of(s.variants.begin(), s.variants.end(), [&](const variant &v) { return v.name == name; })) {
+            continue;
+        }
+        rows << "<tr><td>" << escape(signature) << "</td><td>" << (st.bytes ? std::to_string(st.bytes) : "-")
+             << "</td><td>" << st.instructions << "</td><td>" << st.stack_accesses << "</td><td>" << st.xmm_moves
+             << "</td></tr>\n";
+    }
+    if (rows.str().empty()) {
+        return;
+    }
+    html << "<h2>Code size</h2>\n<table><tr><th>function</th><th>bytes</th><th>instructions</th>"
+         << "<th>stack accesses</th><th>gpr/xmm moves</th></tr>\n"
+         << rows.str() << "</table>\n";
+}
+
+void write_page(const fs::path &path, const options &opt, const std::vector<std::string> &lines,
+                const section &s, const std::map<std::string, std::vector<asm_line>> &functions,
+                const std::map<std::string, function_stats> &stats, const std::string &error,
+                const std::vector<timing> &timings, const std::vector<counter> &counters) {
+    std::ofstream html(path);
+    html << "<!DOCTYPE html>\n<html><head><meta charset='utf-8'><title>" << escape(s.title)
+         << "</title>\n<style>\n"
+         << "body{font-family:sans-serif;margin:2em;max-width:1400px}\n"
+         << "pre{font-size:12px;line-height:1.35;margin:0;overflow-x:auto}\n"
+         << ".pair{display:grid;grid-template-columns:1fr 1fr;gap:1em;margin-bottom:2em}\n"
+         << ".pair>div{border:1px solid #ccc;padding:.5em}\n"
+         << ".n{color:#999;display:inline-block;width:3em}\n"
+         << "table{border-collapse:collapse;margin-bottom:2em}td,th{border:1px solid #ccc;padding:2px 8px}\n"
+         << ".err{color:#a00}\n"
+         << "</style></head><body>\n";
+    html << "<h1>" << escape(s.title) << "</h1>\n<p>" << escape(opt.source.filename().string()) << " &mdash; "
+         << escape(opt.cxx + " " + opt.flags) << "</p>\n<pre>";
+    for (std::size_t l = s.header_first; l + 2 < s.body_first; ++l) {
+        html << escape(lines[l]) << '\n';
+    }
+    html << "</pre>\n";
+
+    if (!error.empty()) {
+        html << "<h2>Compilation failed</h2>\n<pre class='err'>" << escape(error) << "</pre>\n";
+    }
+
+    for (const auto &v : s.variants) {
+        html << "<h2>" << escape(v.name) << "</h2>\n<div class='pair'><div><pre>";
+        for (std::size_t l = v.first_line; l <= v.last_line; ++l) {
+            html << "<span style='background:" << line_colour(l) << "'><span class='n'>" << l << "</span>"
+                 << escape(lines[l - 1]) << "</span>\n";
+        }
+        html << "</pre></div><div><pre>";
+        for (const auto &[signature, body] : functions) {
+            if (bare_name(signature) != v.name) {
+                continue;
+            }
+            for (const auto &a : body) {
+                const bool mapped = a.source_line >= v.first_line && a.source_line <= v.last_line;
+                html << "<span style='background:" << line_colour(mapped ? a.source_line : 0) << "'>"
+                     << escape(a.text) << "</span>\n";
+            }
+        }
+        html << "</pre></div></div>\n";
+    }
+
+    write_code_size(html, s, stats);
+    if (!counters.empty()) {
+        html << "<h2>Counters</h2>\n";
+        write_counters(html, counters);
+    }
+    if (!timings.empty() && is_sweep(timings)) {
+        html << "<h2>Throughput over working set (bytes)</h2>\n";
+        write_sweep_chart(html, timings, counters);
+    } else if (!timings.empty()) {
+        html << "<h2>Timings (ns per item)</h2>\n";
+        write_chart(html, timings);
+    }
+    html << "</body></html>\n";
+}
+
+bool parse_args(int argc, char **argv, options &opt) {
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        const bool has_value = i + 1 < argc;
+        if (arg == "--out" && has_value) {
+            opt.out = argv[++i];
+        } else if (arg == "--cxx" && has_value) {
+            opt.cxx = argv[++i];
+        } else if (arg == "--flags" && has_value) {
+            opt.flags = argv[++i];
+        } else if (arg == "--timings" && has_value) {
+            opt.timings = argv[++i];
+        } else if (arg == "--counters" && has_value) {
+            opt.counters = argv[++i];
+        } else if (!arg.empty() && arg[0] != '-' && opt.source.empty()) {
+            opt.source = arg;
+        } else {
+            return false;
+        }
+    }
+    return !opt.source.empty();
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    options opt;
+    if (!parse_args(argc, argv, opt)) {
+        std::cerr << "usage: " << argv[0]
+                  << " <source.cpp> [--out dir] [--cxx g++] [--flags \"-O2 -std=c++20\"]"
+                     " [--timings timings.csv] [--counters counters.csv]\n";
+        return 1;
+    }
+
+    std::ifstream in(opt.source);
+    if (!in) {
+        std::cerr << "cannot read " << opt.source << '\n';
+        return 1;
+    }
+    std::vector<std::string> lines;
+    for (std::string line; std::getline(in, line);) {
+        lines.push_back(line);
+    }
+
+    const auto sections = parse_sections(lines);
+    const auto timings = read_timings(opt.timings);
+    const auto counters = read_counters(opt.counters);
+    const fs::path work = opt.out / "work";
+    fs::create_directories(work);
+
+    for (const auto &s : sections) {
+        std::string error;
+        std::map<std::string, function_stats> stats;
+        auto functions = compile_section(opt, lines, s, work, false, error, stats);
+        if (!error.empty()) {
+            std::string with_preceding_error;
+            std::map<std::string, function_stats> with_preceding_stats;
+            auto with_preceding =
+                compile_section(opt, lines, s, work, true, with_preceding_error, with_preceding_stats);
+            if (with_preceding_error.empty()) {
+                functions = std::move(with_preceding);
+                stats = std::move(with_preceding_stats);
+                error.clear();
+            }
+        }
+        const auto t = timings.find(s.slug);
+        const auto c = counters.find(s.slug);
+        const fs::path page = opt.out / (s.slug + ".html");
+        write_page(page, opt, lines, s, functions, stats, error, t == timings.end() ? std::vector<timing>{} : t->second,
+                   c == counters.end() ? std::vector<counter>{} : c->second);
+        std::cout << page.string() << (error.empty() ? "" : "  (compilation failed)") << '\n';
+    }
+    return 0;
+}
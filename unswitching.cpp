@@ -0,0 +1,209 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Loop unswitching - https://en.wikipedia.org/wiki/Loop_unswitching
+//
+// The branching.cpp examples take a YesNo and branch once; the loops in looping.cpp don't branch
+// at all. Real code is usually both: a hot loop with an if on a flag that can't change while the
+// loop runs. The branch itself predicts perfectly, but it still costs:
+//  - an extra test (or, as here, both sides computed and a cmov to pick one) every iteration
+//  - a loop with a condition in it is harder to vectorise
+//
+// Unswitching moves the if outside and gives each side its own copy of the loop. Doing it by
+// hand with a template<bool> keeps one copy of the source: the flag becomes a template argument,
+// if constexpr drops the dead side at compile time, and a one line dispatcher picks the
+// instantiation at run time.
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include <algorithm>
+#include <cstddef> //size_t
+#include <cstdint>
+#include <vector>
+
+enum class YesNo : std::uint8_t {
+    Yes,
+    No
+};
+
+void scale_1(std::vector<int> &v, int factor, YesNo clamp) {
+    for (std::size_t i = 0; i < v.size(); ++i) {
+        int x = v[i] * factor;
+        if (clamp == YesNo::Yes) {
+            x = std::min(x, 1000);
+        }
+        v[i] = x;
+    }
+}
+
+template <bool Clamp>
+void scale_kernel(std::vector<int> &v, int factor) {
+    for (std::size_t i = 0; i < v.size(); ++i) {
+        int x = v[i] * factor;
+        if constexpr (Clamp) {
+            x = std::min(x, 1000);
+        }
+        v[i] = x;
+    }
+}
+
+void scale_2(std::vector<int> &v, int factor, YesNo clamp) {
+    if (clamp == YesNo::Yes) {
+        scale_kernel<true>(v, factor);
+    } else {
+        scale_kernel<false>(v, factor);
+    }
+}
+
+// scale_1(std::vector<int>&, int, YesNo):                  // g++ -O2
+//         ...                                              //
+// .L4:                                                     //
+//         mov     eax, DWORD PTR [r8+rcx*4]                //
+//         mov     edi, 1000                                //
+//         imul    eax, esi                                 //
+//         cmp     eax, edi                                 //
+//         cmovle  edi, eax                                 // clamped value worked out whatever the flag
+//         test    dl, dl                                   // flag tested every iteration
+//         cmove   eax, edi                                 //
+//         mov     DWORD PTR [r8+rcx*4], eax                //
+//         inc     rcx                                      //
+//         cmp     rcx, r9                                  //
+//         jb      .L4                                      //
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Compiler unswitching (-funswitch-loops)
+//
+// GCC will do the same on its own with -funswitch-loops, which is on at -O3 but not -O2. It only
+// unswitches conditions that are invariant in the loop and only while the copies stay small
+// (--param max-unswitch-insns, max-unswitch-level). Nothing in the source says it happened, so a
+// small change to the loop body can silently undo it; the template version can't be undone.
+//
+// The optimize attribute turns it on for one function at -O2 for the sake of the example. GCC's
+// documentation says the attribute is for debugging; in real code use the command line flag.
+// At -O3 the unswitched loops are also vectorised, scale_1 included.
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include <algorithm>
+#include <cstddef> //size_t
+#include <vector>
+
+[[gnu::optimize("unswitch-loops")]]
+void scale_3(std::vector<int> &v, int factor, YesNo clamp) {
+    for (std::size_t i = 0; i < v.size(); ++i) {
+        int x = v[i] * factor;
+        if (clamp == YesNo::Yes) {
+            x = std::min(x, 1000);
+        }
+        v[i] = x;
+    }
+}
+
+// scale_3(std::vector<int>&, int, YesNo):                  // g++ -O2
+//         ...                                              //
+//         test    dl, dl                                   // flag tested once
+//         je      .L12                                     //
+// .L11:                                                    //
+//         mov     edx, DWORD PTR [rcx+rax*4]               // No: just the multiply
+//         imul    edx, esi                                 //
+//         mov     DWORD PTR [rcx+rax*4], edx               //
+//         inc     rax                                      //
+//         cmp     rax, rdi                                 //
+//         jb      .L11                                     //
+//         ret                                              //
+// .L12:                                                    //
+//         ...                                              //
+// .L10:                                                    //
+//         mov     eax, DWORD PTR [rcx+rdx*4]               // Yes: multiply and clamp
+//         imul    eax, esi                                 //
+//         vmovd   xmm0, eax                                //
+//         vpminsd xmm0, xmm0, xmm1                         //
+//         vmovd   DWORD PTR [rcx+rdx*4], xmm0              //
+//         inc     rdx                                      //
+//         cmp     rdx, rdi                                 //
+//         jb      .L10                                     //
+//         ret                                              //
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Unswitching several flags
+//
+// Each flag doubles the number of loop copies: 3 flags is 8 instantiations, 5 is 32. Past a few
+// the extra code starts to cost more than the branches did - it has to be compiled, it fills the
+// i-cache and iTLB, and only the combinations that are actually used are ever warm.
+//
+// Options, best first:
+//  - turn flags into data where it's free: "scale or not" is a multiply by factor or by 1
+//  - unswitch only the flags that change the shape of the loop (here the clamps), and leave the
+//    rest as predictable branches or arithmetic
+//  - dispatch through a table of instantiations indexed by the flag bits, rather than nested ifs
+//
+// Code size (g++ 12, -march=znver4, bytes of .text from nm -S):
+//
+//                                  -O2     -O3 (vectorised)
+//   transform_1                     84     3215 (GCC unswitched it itself)
+//   transform_2's 8 kernels        460     3294
+//   transform_3's 4 kernels        262     1932
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include <algorithm>
+#include <cstddef> //size_t
+#include <vector>
+
+void transform_1(std::vector<int> &v, int factor, YesNo scale, YesNo clamp_low, YesNo clamp_high) {
+    for (std::size_t i = 0; i < v.size(); ++i) {
+        int x = v[i];
+        if (scale == YesNo::Yes) {
+            x *= factor;
+        }
+        if (clamp_low == YesNo::Yes) {
+            x = std::max(x, 0);
+        }
+        if (clamp_high == YesNo::Yes) {
+            x = std::min(x, 1000);
+        }
+        v[i] = x;
+    }
+}
+
+template <bool Scale, bool ClampLow, bool ClampHigh>
+void transform_kernel(std::vector<int> &v, int factor) {
+    for (std::size_t i = 0; i < v.size(); ++i) {
+        int x = v[i];
+        if constexpr (Scale) {
+            x *= factor;
+        }
+        if constexpr (ClampLow) {
+            x = std::max(x, 0);
+        }
+        if constexpr (ClampHigh) {
+            x = std::min(x, 1000);
+        }
+        v[i] = x;
+    }
+}
+
+// all 8 combinations
+void transform_2(std::vector<int> &v, int factor, YesNo scale, YesNo clamp_low, YesNo clamp_high) {
+    using kernel = void (*)(std::vector<int> &, int);
+    static constexpr kernel kernels[8] = {
+        transform_kernel<false, false, false>, transform_kernel<false, false, true>,
+        transform_kernel<false, true, false>,  transform_kernel<false, true, true>,
+        transform_kernel<true, false, false>,  transform_kernel<true, false, true>,
+        transform_kernel<true, true, false>,   transform_kernel<true, true, true>,
+    };
+    const unsigned index = (scale == YesNo::Yes) << 2 | (clamp_low == YesNo::Yes) << 1 | (clamp_high == YesNo::Yes);
+    kernels[index](v, factor);
+}
+
+// scale folded into the data (multiply by 1), only the clamps unswitched: 4 combinations
+void transform_3(std::vector<int> &v, int factor, YesNo scale, YesNo clamp_low, YesNo clamp_high) {
+    using kernel = void (*)(std::vector<int> &, int);
+    static constexpr kernel kernels[4] = {
+        transform_kernel<true, false, false>, transform_kernel<true, false, true>,
+        transform_kernel<true, true, false>,  transform_kernel<true, true, true>,
+    };
+    const unsigned index = (clamp_low == YesNo::Yes) << 1 | (clamp_high == YesNo::Yes);
+    kernels[index](v, scale == YesNo::Yes ? factor : 1);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////